@@ -0,0 +1,241 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../Benchmark/timing.h"
+#include "../Yay295/APS.h"
+#include "batchfile.h"
+
+
+// Solves every matrix of a batch file with the APSO, and writes their
+// assignments to a result file. See batchfile.h for both formats.
+//
+// Usage: batch [--threads N] [--chunk N] INPUT OUTPUT
+//
+// The input is mapped into memory and split into chunks of --chunk matrices
+// (by default, as many as fit in 1 MiB). Each of the --threads threads (one per
+// CPU by default) takes the next chunk, asks the kernel to start reading the
+// chunk that the next round of threads will take, solves its chunk into its
+// own buffer, and writes the buffer straight to the chunk's place in the
+// output. Every record has the same size, so the output is in order no matter
+// which thread finishes first, and reading, solving, and writing all overlap.
+
+
+struct Job {
+	const unsigned char * matrices; // the first matrix of the input
+	int output;
+	BatchHeader header;
+	size_t matrixSize, resultSize;
+	size_t chunk, chunks, threads;
+	std::atomic<size_t> next{0};
+	std::atomic<bool> failed{false};
+};
+
+
+// Asks the kernel to start reading a chunk of the input, if there is one.
+void prefetch(const Job & job, const size_t chunk) {
+	if (chunk >= job.chunks) return;
+
+	const size_t page = size_t(sysconf(_SC_PAGESIZE));
+	const uintptr_t start = uintptr_t(job.matrices + chunk * job.chunk * job.matrixSize);
+	const uintptr_t end = start + std::min(job.chunk, job.header.count - chunk * job.chunk) * job.matrixSize;
+	const uintptr_t aligned = start / page * page;
+	madvise(reinterpret_cast<void *>(aligned), end - aligned, MADV_WILLNEED);
+}
+
+// Writes all of `size` bytes at `offset`, and returns whether it could.
+bool writeAll(const int fd, const unsigned char * data, size_t size, off_t offset) {
+	while (size) {
+		const ssize_t written = pwrite(fd, data, size, offset);
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			return false;
+		}
+		data += written;
+		size -= size_t(written);
+		offset += written;
+	}
+	return true;
+}
+
+
+// Solves chunks of matrices with costs of type T until there are none left.
+template<typename T>
+void work(Job & job) {
+	typedef typename std::make_unsigned<T>::type U;
+
+	// Flipping the sign bit maps signed costs to unsigned ones in the same
+	// order, which is what the APSO needs.
+	constexpr U signBit = std::is_signed<T>::value ? U(U(1) << (sizeof(U) * 8 - 1)) : 0;
+
+	const size_t width = job.header.width, height = job.header.height;
+	std::vector<U> values;
+	std::vector<uint32_t> columns(height);
+	std::vector<unsigned char> records(job.chunk * job.resultSize);
+
+	for (size_t chunk; (chunk = job.next++) < job.chunks;) {
+		const size_t first = chunk * job.chunk;
+		const size_t last = std::min(first + job.chunk, size_t(job.header.count));
+
+		prefetch(job, chunk + job.threads);
+
+		for (size_t index = first; index < last; ++index) {
+			const T * const costs = reinterpret_cast<const T *>(job.matrices + index * job.matrixSize);
+
+			values.resize(width * height);
+			for (size_t i = 0; i < width * height; ++i)
+				values[i] = U(costs[i]) ^ signBit;
+
+			// This constructor solves `values` in place, so it is reused.
+			const APSO apso(values, width, height);
+
+			uint64_t total = 0;
+			std::fill(columns.begin(), columns.end(), BATCH_UNASSIGNED);
+			for (const auto & result : apso.results) {
+				columns[result.y] = uint32_t(result.x);
+				total += uint64_t(costs[result.y*width+result.x]);
+			}
+
+			unsigned char * const record = &records[(index - first) * job.resultSize];
+			std::memcpy(record, &total, sizeof(total));
+			std::memcpy(record + sizeof(total), columns.data(), height * sizeof(uint32_t));
+		}
+
+		if (!writeAll(job.output, records.data(), (last - first) * job.resultSize, off_t(sizeof(BatchHeader) + first * job.resultSize))) {
+			std::perror("write");
+			job.failed = true;
+			return;
+		}
+	}
+}
+
+void (*worker(const BatchType type))(Job &) {
+	switch (type) {
+		case BATCH_U8: return &work<uint8_t>;
+		case BATCH_U16: return &work<uint16_t>;
+		case BATCH_U32: return &work<uint32_t>;
+		case BATCH_U64: return &work<uint64_t>;
+		case BATCH_I8: return &work<int8_t>;
+		case BATCH_I16: return &work<int16_t>;
+		case BATCH_I32: return &work<int32_t>;
+		case BATCH_I64: return &work<int64_t>;
+		default: return nullptr;
+	}
+}
+
+
+int usage() {
+	std::cerr << "Usage: batch [--threads N] [--chunk N] INPUT OUTPUT\n";
+	return 1;
+}
+
+int main(int argc, char ** argv) {
+	size_t threads = std::max(std::thread::hardware_concurrency(), 1u), chunk = 0;
+	const char * inputPath = nullptr, * outputPath = nullptr;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+
+		if (arg == "--threads" && i + 1 < argc) {
+			threads = std::stoull(argv[++i]);
+			if (!threads) return usage();
+		} else if (arg == "--chunk" && i + 1 < argc) {
+			chunk = std::stoull(argv[++i]);
+			if (!chunk) return usage();
+		} else if (!inputPath) {
+			inputPath = argv[i];
+		} else if (!outputPath) {
+			outputPath = argv[i];
+		} else return usage();
+	}
+
+	if (!outputPath) return usage();
+
+	const int input = open(inputPath, O_RDONLY);
+	struct stat info;
+	if (input < 0 || fstat(input, &info) != 0) {
+		std::perror(inputPath);
+		return 1;
+	}
+	if (size_t(info.st_size) < sizeof(BatchHeader)) {
+		std::cerr << inputPath << ": too short to be a batch file\n";
+		return 1;
+	}
+
+	void * const mapped = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, input, 0);
+	if (mapped == MAP_FAILED) {
+		std::perror(inputPath);
+		return 1;
+	}
+	madvise(mapped, size_t(info.st_size), MADV_SEQUENTIAL);
+
+	Job job;
+	std::memcpy(&job.header, mapped, sizeof(BatchHeader));
+	if (const char * const problem = batch_check(&job.header, BATCH_MAGIC)) {
+		std::cerr << inputPath << ": " << problem << '\n';
+		return 1;
+	}
+
+	job.matrices = static_cast<const unsigned char *>(mapped) + sizeof(BatchHeader);
+	job.matrixSize = batch_matrix_size(&job.header);
+	job.resultSize = batch_result_size(&job.header);
+	if ((size_t(info.st_size) - sizeof(BatchHeader)) / job.matrixSize < job.header.count) {
+		std::cerr << inputPath << ": has fewer than " << job.header.count << " matrices\n";
+		return 1;
+	}
+
+	job.chunk = chunk ? chunk : std::max((size_t(1) << 20) / job.matrixSize, size_t(1));
+	job.chunks = (job.header.count + job.chunk - 1) / job.chunk;
+	job.threads = threads;
+
+	job.output = open(outputPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	BatchHeader resultHeader = job.header;
+	std::memcpy(resultHeader.magic, BATCH_RESULT_MAGIC, 4);
+	if (job.output < 0
+	    || !writeAll(job.output, reinterpret_cast<const unsigned char *>(&resultHeader), sizeof(resultHeader), 0)
+	    || ftruncate(job.output, off_t(sizeof(BatchHeader) + job.header.count * job.resultSize)) != 0) {
+		std::perror(outputPath);
+		return 1;
+	}
+
+	const uint64_t start = timing_now();
+
+	// The first round of chunks is read ahead here, and each thread reads
+	// ahead the chunk that will be taken a round after its own.
+	for (size_t i = 0; i < threads; ++i)
+		prefetch(job, i);
+
+	void (* const solve)(Job &) = worker(BatchType(job.header.type));
+	std::vector<std::thread> pool;
+	for (size_t i = 0; i < threads; ++i)
+		pool.emplace_back(solve, std::ref(job));
+	for (auto & thread : pool)
+		thread.join();
+
+	const double seconds = timing_seconds(start, timing_now());
+
+	if (close(job.output) != 0) {
+		std::perror(outputPath);
+		return 1;
+	}
+	munmap(mapped, size_t(info.st_size));
+	close(input);
+
+	if (job.failed) return 1;
+
+	std::cerr << "Solved " << job.header.count << ' ' << job.header.width << 'x' << job.header.height << ' '
+	          << batch_type_name(BatchType(job.header.type)) << " matrices in " << seconds << "s ("
+	          << double(job.header.count) / seconds << " per second) with " << threads << " threads\n";
+	return 0;
+}
@@ -0,0 +1,125 @@
+/*
+Binary batch files of cost matrices, and of their assignments.
+
+A batch file holds many matrices of the same size and type:
+
+	offset  size  field
+	0       4     magic, "APSB"
+	4       2     version, 1
+	6       2     type of the costs, a BatchType
+	8       4     width
+	12      4     height
+	16      8     count, the number of matrices
+	24      8     reserved, 0
+	32            count matrices, each width * height costs in row-major order
+
+Everything is little-endian, and there is no padding between the matrices, so
+matrix i starts at byte 32 + i * width * height * batch_type_size(type). Since
+the header is 32 bytes, every cost is aligned to its size when the file is
+mapped into memory.
+
+A result file has the same header, with the magic "APSR" and the type of the
+costs that were solved, followed by one record per matrix, in the same order:
+
+	0       8     the total cost of the assignment, as a 64-bit two's complement
+	              sum of the costs (so it is signed if the costs are signed)
+	8       4*h   the column assigned to each row, or BATCH_UNASSIGNED
+
+Every record is batch_result_size() bytes, so record i is at byte
+32 + i * batch_result_size().
+*/
+
+#ifndef BATCHFILE_H
+#define BATCHFILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+
+#define BATCH_MAGIC         "APSB"
+#define BATCH_RESULT_MAGIC  "APSR"
+#define BATCH_VERSION       1
+#define BATCH_UNASSIGNED    0xFFFFFFFFu
+
+
+typedef enum {
+	BATCH_U8 = 1,
+	BATCH_U16,
+	BATCH_U32,
+	BATCH_U64,
+	BATCH_I8,
+	BATCH_I16,
+	BATCH_I32,
+	BATCH_I64,
+	BATCH_TYPES /* one more than the last type */
+} BatchType;
+
+typedef struct {
+	char magic[4];
+	uint16_t version;
+	uint16_t type;
+	uint32_t width;
+	uint32_t height;
+	uint64_t count;
+	uint64_t reserved;
+} BatchHeader;
+
+
+/* Returns the size in bytes of one cost of a type. */
+static inline size_t batch_type_size(BatchType type) {
+	static const size_t sizes[BATCH_TYPES] = {0, 1, 2, 4, 8, 1, 2, 4, 8};
+	return type > 0 && type < BATCH_TYPES ? sizes[type] : 0;
+}
+
+/* Returns the name of a type, as it is given on the command line. */
+static inline const char * batch_type_name(BatchType type) {
+	static const char * const names[BATCH_TYPES] = {"?", "u8", "u16", "u32", "u64", "i8", "i16", "i32", "i64"};
+	return type > 0 && type < BATCH_TYPES ? names[type] : names[0];
+}
+
+/* Returns the type with the given name, or 0 if there is none. */
+static inline BatchType batch_type_parse(const char *name) {
+	int type;
+	for (type = 1; type < BATCH_TYPES; ++type)
+		if (strcmp(name, batch_type_name((BatchType)type)) == 0)
+			return (BatchType)type;
+	return (BatchType)0;
+}
+
+
+/* Returns a header for `count` matrices of `width` x `height` costs. */
+static inline BatchHeader batch_header(const char *magic, BatchType type, uint32_t width, uint32_t height, uint64_t count) {
+	BatchHeader header;
+	memcpy(header.magic, magic, 4);
+	header.version = BATCH_VERSION;
+	header.type = (uint16_t)type;
+	header.width = width;
+	header.height = height;
+	header.count = count;
+	header.reserved = 0;
+	return header;
+}
+
+/* Returns the size in bytes of one matrix. */
+static inline size_t batch_matrix_size(const BatchHeader *header) {
+	return (size_t)header->width * header->height * batch_type_size((BatchType)header->type);
+}
+
+/* Returns the size in bytes of one result record. */
+static inline size_t batch_result_size(const BatchHeader *header) {
+	return 8 + 4 * (size_t)header->height;
+}
+
+/* Returns NULL if the header is valid and has the given magic, or else what
+   is wrong with it. */
+static inline const char * batch_check(const BatchHeader *header, const char *magic) {
+	if (memcmp(header->magic, magic, 4) != 0) return "wrong magic number";
+	if (header->version != BATCH_VERSION) return "unsupported version";
+	if (!batch_type_size((BatchType)header->type)) return "unknown cost type";
+	if (!header->width || !header->height) return "empty matrices";
+	return NULL;
+}
+
+
+#endif /* BATCHFILE_H */
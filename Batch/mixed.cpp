@@ -0,0 +1,138 @@
+#include <iostream>
+#include <cstdio>
+#include <vector>
+#include <string>
+#include <thread>
+#include <algorithm>
+#include <limits>
+#include "../Benchmark/timing.h"
+#include "../Benchmark/generators.h"
+#include "../Yay295/apso.h"
+
+
+// Solves a batch of matrices of different sizes twice, with the same number of
+// threads: split between the threads up front, and with apso_solve_batch, and
+// prints how long each took and how busy each thread was.
+//
+// Usage: mixed [--threads N] [--family F] [--seed N] [WIDTHxHEIGHTxCOUNT ...]
+//
+// The matrices are u32 matrices from a family in generators.h (uniform by
+// default), 20x20x2000, 100x100x100, and 600x600x1 by default, in that order.
+// The up front split gives the threads every --threads'th matrix, so each gets
+// the same number of each size, which is as even as a split can be without
+// knowing how long each matrix takes. Both must give assignments with the same
+// totals.
+
+
+struct Problem {
+	std::vector<uint32_t> costs;
+	size_t width, height;
+};
+
+
+uint64_t total(const Problem & problem, const std::vector<int32_t> & columns) {
+	uint64_t total = 0;
+	for (size_t row = 0; row < problem.height; ++row)
+		if (columns[row] >= 0) total += problem.costs[row*problem.width+size_t(columns[row])];
+	return total;
+}
+
+void print(const char * const name, const double seconds, const std::vector<double> & utilization) {
+	std::printf("%-10s %9.4f s  busy", name, seconds);
+	for (const double busy : utilization)
+		std::printf(" %3.0f%%", busy * 100);
+	std::printf("\n");
+}
+
+
+int usage() {
+	std::cerr << "Usage: mixed [--threads N] [--family F] [--seed N] [WIDTHxHEIGHTxCOUNT ...]\n";
+	return 1;
+}
+
+int main(int argc, char ** argv) {
+	unsigned threads = std::max(std::thread::hardware_concurrency(), 1u);
+	GeneratorFamily family = GENERATOR_UNIFORM;
+	unsigned long long seed = 1;
+	struct Size { size_t width, height, count; };
+	std::vector<Size> sizes;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		Size size;
+
+		if (arg == "--threads" && i + 1 < argc) {
+			threads = unsigned(std::stoul(argv[++i]));
+			if (!threads) return usage();
+		} else if (arg == "--family" && i + 1 < argc) {
+			family = generator_parse(argv[++i]);
+			if (family == GENERATOR_FAMILIES) return usage();
+		} else if (arg == "--seed" && i + 1 < argc) {
+			seed = std::stoull(argv[++i]);
+		} else if (std::sscanf(argv[i], "%zux%zux%zu", &size.width, &size.height, &size.count) == 3 && size.width && size.height) {
+			sizes.push_back(size);
+		} else return usage();
+	}
+
+	if (sizes.empty()) sizes = {{20, 20, 2000}, {100, 100, 100}, {600, 600, 1}};
+
+	std::vector<Problem> problems;
+	std::vector<unsigned long> costs;
+	for (const auto & size : sizes) {
+		for (size_t i = 0; i < size.count; ++i) {
+			costs.resize(size.width * size.height);
+			generator_fill(family, generator_mix(seed, problems.size()), size.width, size.height, costs.data());
+
+			problems.push_back({std::vector<uint32_t>(costs.size()), size.width, size.height});
+			std::transform(costs.begin(), costs.end(), problems.back().costs.begin(),
+			               [](const unsigned long cost) { return uint32_t(std::min<unsigned long>(cost, std::numeric_limits<uint32_t>::max())); });
+		}
+	}
+
+	std::vector<std::vector<int32_t>> splitColumns(problems.size()), batchColumns(problems.size());
+	for (size_t i = 0; i < problems.size(); ++i) {
+		splitColumns[i].resize(problems[i].height);
+		batchColumns[i].resize(problems[i].height);
+	}
+
+	// Split up front.
+	std::vector<double> busy(threads);
+	uint64_t start = timing_now();
+	std::vector<std::thread> pool;
+	for (unsigned thread = 0; thread < threads; ++thread) {
+		pool.emplace_back([&, thread] {
+			const uint64_t started = timing_now();
+			for (size_t i = thread; i < problems.size(); i += threads)
+				apso_solve(problems[i].costs.data(), problems[i].width, problems[i].height, problems[i].width, APSO_U32, splitColumns[i].data(), NULL);
+			busy[thread] = timing_seconds(started, timing_now());
+		});
+	}
+	for (auto & thread : pool)
+		thread.join();
+	double seconds = timing_seconds(start, timing_now());
+	for (double & time : busy) time /= seconds;
+	print("split", seconds, busy);
+
+	// Work stealing.
+	std::vector<apso_problem> batch(problems.size());
+	for (size_t i = 0; i < problems.size(); ++i)
+		batch[i] = {problems[i].costs.data(), problems[i].width, problems[i].height, problems[i].width, batchColumns[i].data(), APSO_OK};
+	start = timing_now();
+	const apso_status status = apso_solve_batch(batch.data(), batch.size(), APSO_U32, threads, busy.data());
+	seconds = timing_seconds(start, timing_now());
+	print("stealing", seconds, busy);
+
+	if (status != APSO_OK) {
+		std::cerr << "apso_solve_batch failed with status " << status << '\n';
+		return 1;
+	}
+
+	size_t different = 0;
+	for (size_t i = 0; i < problems.size(); ++i)
+		different += total(problems[i], splitColumns[i]) != total(problems[i], batchColumns[i]);
+	if (different) {
+		std::cout << different << " matrices had different totals\n";
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,110 @@
+#include <iostream>
+#include <cstdio>
+#include <vector>
+#include <string>
+#include <limits>
+#include <type_traits>
+#include <algorithm>
+#include "batchfile.h"
+#include "../Benchmark/generators.h"
+
+
+// Writes a batch file of seeded random matrices, for testing the batch driver.
+//
+// Usage: mkbatch [--family F] [--type T] [--seed N] WIDTHxHEIGHTxCOUNT OUTPUT
+//
+// The matrices come from a family in generators.h (uniform by default). Costs
+// that do not fit the type (u32 by default) wrap around. Costs of signed types
+// have the middle of their matrix's costs subtracted, so that they spread
+// evenly around zero, whatever the family's range is.
+
+
+template<typename T>
+void convert(const std::vector<unsigned long> & costs, std::vector<char> & out) {
+	const size_t size = costs.size();
+
+	unsigned long offset = 0;
+	if (std::is_signed<T>::value && size) {
+		const auto range = std::minmax_element(costs.begin(), costs.end());
+		offset = *range.first + (*range.second - *range.first) / 2;
+	}
+
+	out.resize(size * sizeof(T));
+	T * const values = reinterpret_cast<T *>(out.data());
+	for (size_t i = 0; i < size; ++i)
+		values[i] = T(costs[i] - offset);
+}
+
+void convert(const BatchType type, const std::vector<unsigned long> & costs, std::vector<char> & out) {
+	switch (type) {
+		case BATCH_U8: convert<uint8_t>(costs, out); break;
+		case BATCH_U16: convert<uint16_t>(costs, out); break;
+		case BATCH_U32: convert<uint32_t>(costs, out); break;
+		case BATCH_U64: convert<uint64_t>(costs, out); break;
+		case BATCH_I8: convert<int8_t>(costs, out); break;
+		case BATCH_I16: convert<int16_t>(costs, out); break;
+		case BATCH_I32: convert<int32_t>(costs, out); break;
+		case BATCH_I64: convert<int64_t>(costs, out); break;
+		default: break;
+	}
+}
+
+
+int usage() {
+	std::cerr << "Usage: mkbatch [--family F] [--type T] [--seed N] WIDTHxHEIGHTxCOUNT OUTPUT\n";
+	return 1;
+}
+
+int main(int argc, char ** argv) {
+	GeneratorFamily family = GENERATOR_UNIFORM;
+	BatchType type = BATCH_U32;
+	unsigned long long seed = 1;
+	size_t width = 0, height = 0, count = 0;
+	const char * path = nullptr;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+
+		if (arg == "--family" && i + 1 < argc) {
+			family = generator_parse(argv[++i]);
+			if (family == GENERATOR_FAMILIES) return usage();
+		} else if (arg == "--type" && i + 1 < argc) {
+			type = batch_type_parse(argv[++i]);
+			if (!type) return usage();
+		} else if (arg == "--seed" && i + 1 < argc) {
+			seed = std::stoull(argv[++i]);
+		} else if (!width) {
+			if (std::sscanf(argv[i], "%zux%zux%zu", &width, &height, &count) != 3 || !width || !height
+			    || width > std::numeric_limits<uint32_t>::max() || height > std::numeric_limits<uint32_t>::max())
+				return usage();
+		} else if (!path) {
+			path = argv[i];
+		} else return usage();
+	}
+
+	if (!path) return usage();
+
+	FILE * const out = std::fopen(path, "wb");
+	if (!out) {
+		std::perror(path);
+		return 1;
+	}
+
+	const BatchHeader header = batch_header(BATCH_MAGIC, type, uint32_t(width), uint32_t(height), count);
+	std::fwrite(&header, sizeof(header), 1, out);
+
+	std::vector<unsigned long> costs(width * height);
+	std::vector<char> bytes;
+	for (size_t index = 0; index < count; ++index) {
+		generator_fill(family, generator_mix(seed, index), width, height, costs.data());
+		convert(type, costs, bytes);
+		std::fwrite(bytes.data(), 1, bytes.size(), out);
+	}
+
+	const bool failed = std::ferror(out);
+	if (std::fclose(out) != 0 || failed) {
+		std::perror(path);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,120 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <limits>
+#include "../Benchmark/timing.h"
+#include "../Benchmark/generators.h"
+#include "../Yay295/APSScheduler.h"
+
+
+// Solves one large matrix on every CPU with APSScheduler, and estimates how
+// much of it was in the memory of another node than the thread that used it.
+// See "Memory Nodes" in APSScheduler.h.
+//
+// Usage: numa [--threads N] [--pin] [--runs N] [--family F] [WIDTHxHEIGHT]
+//
+// The matrix is a u32 matrix from a family in generators.h (uniform by
+// default) of 500x500 by default. It is made by this thread, and then solved
+// --runs times (3 by default) by the --threads workers (one per CPU by
+// default), pinned to their CPUs with --pin. The APSO copies the matrix a
+// range of rows at a time on the workers, so the copy is placed by them.
+//
+// With --pin, the share of remote pages is estimated for the matrix as this
+// thread placed it, and for a buffer of the same size placed the way the APSO
+// places its copy. Run it under numactl (see `make numa`) to compare this with
+// other placements: with --membind, every page is on the nodes given, and with
+// --interleave, the pages are spread over the nodes in turn.
+
+
+int usage() {
+	std::cerr << "Usage: numa [--threads N] [--pin] [--runs N] [--family F] [WIDTHxHEIGHT]\n";
+	return 1;
+}
+
+void printRemote(const char * const name, const double remote) {
+	if (remote < 0) std::printf("%-20s unknown\n", name);
+	else std::printf("%-20s %5.1f%% of pages remote\n", name, remote * 100);
+}
+
+int main(int argc, char ** argv) {
+	unsigned threads = std::max(std::thread::hardware_concurrency(), 1u);
+	bool pin = false;
+	size_t runs = 3, width = 500, height = 500;
+	GeneratorFamily family = GENERATOR_UNIFORM;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+
+		if (arg == "--threads" && i + 1 < argc) {
+			threads = unsigned(std::stoul(argv[++i]));
+			if (!threads) return usage();
+		} else if (arg == "--pin") {
+			pin = true;
+		} else if (arg == "--runs" && i + 1 < argc) {
+			runs = std::stoull(argv[++i]);
+			if (!runs) return usage();
+		} else if (arg == "--family" && i + 1 < argc) {
+			family = generator_parse(argv[++i]);
+			if (family == GENERATOR_FAMILIES) return usage();
+		} else if (std::sscanf(argv[i], "%zux%zu", &width, &height) != 2 || !width || !height) {
+			return usage();
+		}
+	}
+
+	std::vector<unsigned long> generated(width * height);
+	generator_fill(family, 1, width, height, generated.data());
+	std::vector<uint32_t> costs(generated.size());
+	std::transform(generated.begin(), generated.end(), costs.begin(),
+	               [](const unsigned long cost) { return uint32_t(std::min<unsigned long>(cost, std::numeric_limits<uint32_t>::max())); });
+	generated = std::vector<unsigned long>();
+
+	APSScheduler scheduler(threads, pin);
+
+	std::vector<double> times(runs);
+	uint64_t total = 0;
+	for (size_t run = 0; run < runs; ++run) {
+		const uint64_t start = timing_now();
+		scheduler.submit([&] {
+			const APSO apso(costs.data(), width, height);
+			total = 0;
+			for (const auto & result : apso.results)
+				total += costs[result.y*width+result.x];
+		});
+		scheduler.wait();
+		times[run] = timing_seconds(start, timing_now());
+	}
+
+	const TimingSummary summary = timing_summarize(times.data(), runs);
+	std::printf("%zux%zu %s, %u threads%s: %.4f s (p50), total %llu\n", width, height, generator_name(family),
+	            threads, pin ? " pinned" : "", summary.p50, (unsigned long long)total);
+
+	const auto stats = scheduler.stats();
+	const auto utilization = scheduler.utilization();
+	for (size_t worker = 0; worker < stats.size(); ++worker)
+		std::printf("worker %2zu: cpu %3d node %2d, %6zu subtasks, %5zu steals, %3.0f%% busy\n", worker, stats[worker].cpu,
+		            stats[worker].node, stats[worker].subtasks, stats[worker].steals, utilization[worker] * 100);
+
+	if (pin) {
+		// The rows the APSO solves are the rows of the matrix, or of its
+		// transpose if it is taller than it is wide.
+		const size_t rows = std::min(width, height), rowBytes = std::max(width, height) * sizeof(uint32_t);
+
+		std::unique_ptr<uint32_t[]> placed(new uint32_t[costs.size()]);
+		scheduler.submit([&] {
+			APSScheduler::parallelFor(rows, [&](const size_t first, const size_t last) {
+				std::memset(&placed[first * rowBytes / sizeof(uint32_t)], 0, (last - first) * rowBytes);
+			});
+		});
+		scheduler.wait();
+
+		printRemote("made by this thread", scheduler.remoteFraction(costs.data(), rowBytes, rows));
+		printRemote("placed like the copy", scheduler.remoteFraction(placed.get(), rowBytes, rows));
+	}
+
+	return 0;
+}
@@ -0,0 +1,373 @@
+/*
+Adapters that give every C and C++ solver in this repository the same
+interface, so that they can be benchmarked on identical inputs.
+
+A matrix is given to a solver as a row-major vector of costs, along with its
+width and height. `load` copies it into whatever layout the solver uses, and
+is not timed. `solve` runs the solver, and is the only part that is timed.
+`columns` then returns the column assigned to each row, or NONE for rows that
+were not assigned (when the matrix is taller than it is wide). Solvers that can
+also return the dual potentials of their solution, which certify.h checks,
+return them from `potentials`. The APSO only does if APS_POTENTIALS is defined.
+*/
+
+#pragma once
+
+
+#ifndef SOLVERS
+#define SOLVERS
+
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <cstdint>
+
+#include "../Yay295/APS.h"
+#ifdef APS_POTENTIALS
+#include "../Yay295/APSComponents.h"
+#endif
+#include "../JohnWeaver/munkres.h"
+#include "../KevinLStern/HungarianAlgorithm.h"
+#include "kuhn.h"
+
+#ifdef BENCH_DLIB
+#include <dlib/optimization/max_cost_assignment.h>
+#endif
+
+
+typedef unsigned long Cost;
+
+constexpr size_t NONE = size_t(-1);
+
+
+class Solver {
+	public:
+
+	virtual ~Solver() {}
+
+	virtual const char * name() const = 0;
+	virtual void load(const std::vector<Cost> & costs, size_t width, size_t height) = 0;
+	virtual void solve() = 0;
+	virtual std::vector<size_t> columns() const = 0;
+
+	// Gets the row and column potentials of the last solve, if the solver
+	// has them, and returns whether it does.
+	virtual bool potentials(std::vector<long long> & /* rows */, std::vector<long long> & /* columns */) const { return false; }
+};
+
+
+// Yay295's APSO, using the constructor that solves its vector in place, with
+// one of its initial matchings. With `view`, it solves the costs where they are
+// instead, which it only does for costs of at most 32 bits, so they are loaded
+// as those when they fit.
+class APSOSolver : public Solver {
+	std::vector<Cost> values;
+	std::vector<uint32_t> values32;
+	size_t width = 0, height = 0;
+	APSO result;
+	const char * const solverName;
+	const APSInit init;
+	const bool view;
+
+	public:
+
+	explicit APSOSolver(const char * const newName = "APSO", const APSInit newInit = APSInit::none, const bool newView = false)
+		: solverName(newName), init(newInit), view(newView) {}
+
+	const char * name() const override { return solverName; }
+
+	void load(const std::vector<Cost> & costs, size_t newWidth, size_t newHeight) override {
+		values32.clear();
+		if (view && std::all_of(costs.begin(), costs.end(), [](Cost cost){ return cost <= std::numeric_limits<uint32_t>::max(); }))
+			values32.assign(costs.begin(), costs.end());
+		else values = costs;
+		width = newWidth;
+		height = newHeight;
+	}
+
+	void solve() override {
+		if (!view) result = APSO(values, width, height, init);
+		else if (!values32.empty()) result = APSO(APSOView(), values32.data(), width, height, init);
+		else result = APSO(APSOView(), values.data(), width, height, init);
+	}
+
+	std::vector<size_t> columns() const override {
+		std::vector<size_t> columns(height, NONE);
+		for (const auto & r : result.results)
+			columns[r.y] = r.x;
+		return columns;
+	}
+
+#ifdef APS_POTENTIALS
+	bool potentials(std::vector<long long> & rows, std::vector<long long> & columns) const override {
+		rows = result.rowPotentials;
+		columns = result.columnPotentials;
+		return true;
+	}
+#endif
+};
+
+
+// Yay295's APSO, solving each connected component of the costs of at most
+// width * height on its own thread. The blocks family is made so that this
+// splits it into its blocks. It needs the potentials to prove its solutions,
+// so it is only built with APS_POTENTIALS.
+#ifdef APS_POTENTIALS
+class APSOComponentsSolver : public Solver {
+	std::vector<Cost> values;
+	size_t width = 0, height = 0;
+	std::unique_ptr<APSOComponents> result;
+
+	public:
+
+	const char * name() const override { return "APSO-components"; }
+
+	void load(const std::vector<Cost> & costs, size_t newWidth, size_t newHeight) override {
+		values = costs;
+		width = newWidth;
+		height = newHeight;
+	}
+
+	void solve() override {
+		result.reset(new APSOComponents(values.data(), width, height, Cost(width * height)));
+	}
+
+	std::vector<size_t> columns() const override {
+		std::vector<size_t> columns(height, NONE);
+		for (const auto & r : result->results)
+			columns[r.y] = r.x;
+		return columns;
+	}
+
+	bool potentials(std::vector<long long> & rows, std::vector<long long> & columns) const override {
+		rows = result->rowPotentials;
+		columns = result->columnPotentials;
+		return true;
+	}
+};
+#endif
+
+
+// John Weaver's Munkres, which keeps its matrix as an array of rows.
+class MunkresSolver : public Solver {
+	Matrix<long> matrix;
+	std::vector<double> rowPotentials, columnPotentials;
+
+	public:
+
+	const char * name() const override { return "Munkres"; }
+
+	void load(const std::vector<Cost> & costs, size_t width, size_t height) override {
+		if (matrix.rows() != height || matrix.columns() != width)
+			matrix = Matrix<long>(height, width);
+
+		for (size_t row = 0; row < height; ++row)
+			for (size_t column = 0; column < width; ++column)
+				matrix(row, column) = long(costs[row*width+column]);
+	}
+
+	void solve() override {
+		Munkres<long> munkres;
+		munkres.solve(matrix);
+		rowPotentials = munkres.row_potentials();
+		columnPotentials = munkres.column_potentials();
+	}
+
+	std::vector<size_t> columns() const override {
+		std::vector<size_t> columns(matrix.rows(), NONE);
+		for (size_t row = 0; row < matrix.rows(); ++row)
+			for (size_t column = 0; column < matrix.columns(); ++column)
+				if (matrix(row, column) == 0)
+					columns[row] = column;
+		return columns;
+	}
+
+	// Munkres works in doubles, which are exact for these integer costs.
+	bool potentials(std::vector<long long> & rows, std::vector<long long> & columns) const override {
+		rows.resize(rowPotentials.size());
+		columns.resize(columnPotentials.size());
+		std::transform(rowPotentials.begin(), rowPotentials.end(), rows.begin(), [](double p){ return std::llround(p); });
+		std::transform(columnPotentials.begin(), columnPotentials.end(), columns.begin(), [](double p){ return std::llround(p); });
+		return true;
+	}
+};
+
+
+// The C++ port of Kevin L. Stern's HungarianAlgorithm.java. Like the Java, it
+// copies the costs into its own padded matrix, so that is part of the solve.
+class SternSolver : public Solver {
+	std::vector<Cost> values;
+	size_t width = 0, height = 0;
+	HungarianAlgorithm<Cost> solver;
+
+	public:
+
+	const char * name() const override { return "Stern"; }
+
+	void load(const std::vector<Cost> & costs, size_t newWidth, size_t newHeight) override {
+		values = costs;
+		width = newWidth;
+		height = newHeight;
+	}
+
+	void solve() override {
+		solver.solve(values.data(), width, height);
+	}
+
+	std::vector<size_t> columns() const override {
+		std::vector<size_t> columns(height, NONE);
+		for (const auto & r : solver.results)
+			columns[r.y] = r.x;
+		return columns;
+	}
+};
+
+
+// Both kuhn_match implementations need the table to be at least as wide as it
+// is tall, so taller matrices are transposed when they are loaded.
+template<typename Cell>
+class KuhnSolver : public Solver {
+	protected:
+
+	std::vector<Cell> table;
+	std::vector<size_t> assigned;
+	std::vector<std::max_align_t> workspace;
+	size_t width = 0, height = 0, n = 0, m = 0;
+
+	void allocate(size_t bytes) {
+		workspace.resize((bytes + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t));
+	}
+
+	public:
+
+	void load(const std::vector<Cost> & costs, size_t newWidth, size_t newHeight) override {
+		width = newWidth;
+		height = newHeight;
+		n = std::min(width, height);
+		m = std::max(width, height);
+		table.resize(n * m);
+		assigned.resize(n);
+
+		for (size_t row = 0; row < height; ++row) {
+			for (size_t column = 0; column < width; ++column) {
+				const Cell value = Cell(costs[row*width+column]);
+				if (height <= width) table[row*m+column] = value;
+				else table[column*m+row] = value;
+			}
+		}
+	}
+
+	std::vector<size_t> columns() const override {
+		std::vector<size_t> columns(height, NONE);
+		for (size_t i = 0; i < n; ++i) {
+			if (height <= width) columns[i] = assigned[i];
+			else columns[assigned[i]] = i;
+		}
+		return columns;
+	}
+};
+
+
+// Mattias Andrée's kuhn_match, using its strided, allocation free entry point.
+class MattiasSolver : public KuhnSolver<long> {
+	public:
+
+	const char * name() const override { return "Mattias"; }
+
+	void load(const std::vector<Cost> & costs, size_t width, size_t height) override {
+		KuhnSolver<long>::load(costs, width, height);
+		allocate(mattias_workspace_size(n, m));
+	}
+
+	void solve() override {
+		mattias_solve(table.data(), n, m, workspace.data(), assigned.data());
+	}
+};
+
+
+// Paolo Bonzini's kuhn_match, using its strided, allocation free entry point.
+class BonziniSolver : public KuhnSolver<size_t> {
+	public:
+
+	const char * name() const override { return "Bonzini"; }
+
+	void load(const std::vector<Cost> & costs, size_t width, size_t height) override {
+		KuhnSolver<size_t>::load(costs, width, height);
+		allocate(bonzini_workspace_size(n, m));
+	}
+
+	void solve() override {
+		bonzini_solve(table.data(), n, m, workspace.data(), assigned.data());
+	}
+};
+
+
+#ifdef BENCH_DLIB
+// dlib's max_cost_assignment. It maximizes the cost of a square matrix, so the
+// costs are subtracted from the largest cost, and the matrix is padded.
+class DlibSolver : public Solver {
+	dlib::matrix<long> matrix;
+	std::vector<long> assignment;
+	size_t width = 0, height = 0;
+
+	public:
+
+	const char * name() const override { return "dlib"; }
+
+	void load(const std::vector<Cost> & costs, size_t newWidth, size_t newHeight) override {
+		width = newWidth;
+		height = newHeight;
+
+		const size_t size = std::max(width, height);
+		const Cost max = *std::max_element(costs.begin(), costs.end());
+
+		matrix.set_size(long(size), long(size));
+		matrix = 0;
+		for (size_t row = 0; row < height; ++row)
+			for (size_t column = 0; column < width; ++column)
+				matrix(long(row), long(column)) = long(max - costs[row*width+column]);
+	}
+
+	void solve() override {
+		assignment = dlib::max_cost_assignment(matrix);
+	}
+
+	std::vector<size_t> columns() const override {
+		std::vector<size_t> columns(height, NONE);
+		for (size_t row = 0; row < height; ++row)
+			if (size_t(assignment[row]) < width)
+				columns[row] = size_t(assignment[row]);
+		return columns;
+	}
+};
+#endif
+
+
+// Creates all of the solvers that were compiled in.
+inline std::vector<std::unique_ptr<Solver>> allSolvers() {
+	std::vector<std::unique_ptr<Solver>> solvers;
+	solvers.emplace_back(new APSOSolver);
+	solvers.emplace_back(new APSOSolver("APSO-first", APSInit::firstZero));
+	solvers.emplace_back(new APSOSolver("APSO-greedy", APSInit::greedy));
+	solvers.emplace_back(new APSOSolver("APSO-transfer", APSInit::transfer));
+	solvers.emplace_back(new APSOSolver("APSO-view", APSInit::none, true));
+#ifdef APS_POTENTIALS
+	solvers.emplace_back(new APSOComponentsSolver);
+#endif
+	solvers.emplace_back(new MunkresSolver);
+	solvers.emplace_back(new SternSolver);
+	solvers.emplace_back(new MattiasSolver);
+	solvers.emplace_back(new BonziniSolver);
+#ifdef BENCH_DLIB
+	solvers.emplace_back(new DlibSolver);
+#endif
+	return solvers;
+}
+
+
+#endif /* SOLVERS */
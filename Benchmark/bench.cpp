@@ -0,0 +1,492 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <sys/resource.h>
+#include "Solvers.h"
+#include "timing.h"
+#include "generators.h"
+#include "certify.h"
+
+
+// Benchmarks every solver on the same seeded random matrices.
+//
+// Usage: bench [--solvers A,B,...] [--families A,B,...|all] [--seed N] [--format text|csv|json] [--certify]
+//              [WIDTHxHEIGHTxCOUNT ... | --sweep MIN-MAX [--aspects WxH,...] [--budget SECONDS]]
+//
+// Every matrix is generated from the seed, its family, its size, and its
+// index, so each solver gets exactly the same inputs. The families are the
+// ones in generators.h. By default only uniform matrices are used, with costs
+// in [0, width * height], like the other test programs in this repository.
+// Before a solver is timed on a size, it solves the first tenth of its
+// matrices without being timed.
+//
+// --sweep times every solver on sizes from MIN to MAX, doubling each time, in
+// each of the aspect ratios given by --aspects (1x1, 4x1, and 1x4 by default).
+// The larger side of the matrix is the size, and the smaller one is scaled to
+// the aspect ratio. Each solver solves up to 1000 matrices of each size, but
+// stops once they add up to --budget seconds (5 by default). Once a solver
+// takes more than the budget on one matrix, it is not timed on larger sizes.
+// The time of each solver is then fitted to size^k, and solvers where k is more
+// than 3 are flagged, since every solver here should be O(n^3).
+//
+// --certify checks every solution of the solvers that have dual potentials
+// with certify.h, after it is timed. This proves each solution is optimal
+// without needing another solver to compare against, so it works for sizes
+// where the other solvers are too slow. The APSO only has potentials when this
+// is built with `make POTENTIALS=1`, because they change how it solves small
+// matrices.
+
+
+struct Size {
+	size_t width, height, count;
+};
+
+struct Fit {
+	std::string solver;
+	GeneratorFamily family;
+	size_t aspectWidth, aspectHeight;
+	size_t from, to; // the sizes fitted
+	double exponent;
+};
+
+// The fitted exponent has to be this much more than 3 to be flagged, because
+// the time of small sizes, caches, and noise make it wobble.
+constexpr double FIT_TOLERANCE = 0.25;
+
+// Sizes that take less time than this on average are not fitted, because their
+// time is mostly overhead.
+constexpr double FIT_MIN_TIME = 1e-4;
+
+
+struct Result {
+	std::string solver;
+	GeneratorFamily family;
+	Size size;
+	TimingSummary times;
+	double throughput;
+	long peakRSS; // in KiB, -1 if unknown
+	size_t mismatches;
+	long uncertified; // -1 if the solutions were not certified
+};
+
+
+// Fills `costs` with matrix number `index` of the given family and size.
+void generate(std::vector<Cost> & costs, const unsigned long long seed, const GeneratorFamily family, const Size & size, const size_t index) {
+	uint64_t matrixSeed = seed;
+	for (uint64_t value : {uint64_t(family), uint64_t(size.width), uint64_t(size.height), uint64_t(index)})
+		matrixSeed = generator_mix(matrixSeed, value);
+
+	costs.resize(size.width * size.height);
+	generator_fill(family, matrixSeed, size.width, size.height, costs.data());
+}
+
+unsigned long long totalCost(const std::vector<Cost> & costs, const size_t width, const std::vector<size_t> & columns) {
+	unsigned long long cost = 0;
+	for (size_t row = 0; row < columns.size(); ++row)
+		if (columns[row] != NONE)
+			cost += costs[row*width+columns[row]];
+	return cost;
+}
+
+
+// Resets the peak resident set size of this process, if the OS allows it.
+void resetPeakRSS() {
+	std::ofstream clearRefs("/proc/self/clear_refs");
+	if (clearRefs) clearRefs << "5";
+}
+
+// Returns the peak resident set size of this process in KiB.
+long peakRSS() {
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line))
+		if (line.compare(0, 6, "VmHWM:") == 0)
+			return std::stol(line.substr(6));
+
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+		return usage.ru_maxrss;
+	return -1;
+}
+
+
+// Times `solver` on `size.count` matrices. If `budget` is not 0, it stops
+// early once the timed solves add up to `budget` seconds, after at least 3, and
+// the warm up stops at a tenth of that.
+Result run(Solver & solver, const GeneratorFamily family, const Size & size, const unsigned long long seed,
+           std::vector<unsigned long long> & referenceCosts, const double budget, const bool certifying) {
+	Result result;
+	result.solver = solver.name();
+	result.family = family;
+	result.size = size;
+	result.mismatches = 0;
+	result.uncertified = -1;
+
+	std::vector<long long> rowPotentials, columnPotentials;
+
+	std::vector<Cost> costs;
+	std::vector<double> times;
+	times.reserve(size.count);
+
+	const bool reference = referenceCosts.empty();
+
+	resetPeakRSS();
+
+	const uint64_t warmupStart = timing_now();
+	for (size_t index = 0; index < TIMING_WARMUP(size.count); ++index) {
+		generate(costs, seed, family, size, index);
+		solver.load(costs, size.width, size.height);
+		solver.solve();
+
+		if (budget && timing_seconds(warmupStart, timing_now()) >= budget / 10) break;
+	}
+
+	double total = 0;
+	for (size_t index = 0; index < size.count; ++index) {
+		generate(costs, seed, family, size, index);
+		solver.load(costs, size.width, size.height);
+
+		const uint64_t start = timing_now();
+		solver.solve();
+		times.push_back(timing_seconds(start, timing_now()));
+		total += times.back();
+
+		const std::vector<size_t> columns = solver.columns();
+		const unsigned long long cost = totalCost(costs, size.width, columns);
+		if (reference) referenceCosts.push_back(cost);
+		else if (index < referenceCosts.size() && cost != referenceCosts[index]) ++result.mismatches;
+
+		if (certifying && solver.potentials(rowPotentials, columnPotentials)) {
+			if (result.uncertified < 0) result.uncertified = 0;
+			if (certify(costs, size.width, size.height, columns, NONE, rowPotentials, columnPotentials))
+				++result.uncertified;
+		}
+
+		if (budget && total >= budget && times.size() >= 3) break;
+	}
+
+	result.size.count = times.size();
+
+	result.peakRSS = peakRSS();
+
+	result.times = timing_summarize(times.data(), times.size());
+	result.throughput = 1 / result.times.mean;
+
+	return result;
+}
+
+
+// Returns the width of the solver column of a text table: the length of the
+// longest solver name in it, or of the heading if that is longer.
+template<typename Row>
+size_t solverWidth(const std::vector<Row> & rows) {
+	size_t width = std::strlen("solver");
+	for (const auto & row : rows)
+		width = std::max(width, row.solver.size());
+	return width;
+}
+
+void printText(const std::vector<Result> & results) {
+	const size_t nameWidth = solverWidth(results);
+	std::cout.width(nameWidth); std::cout << std::left << "solver";
+	std::cout << " family     size          count         mean          p50          p90          p99          max  outliers    solves/s  peak KiB  mismatches  uncertified\n";
+	for (const auto & r : results) {
+		std::ostringstream size;
+		size << r.size.width << 'x' << r.size.height;
+
+		std::cout.width(nameWidth); std::cout << std::left << r.solver << ' ';
+		std::cout.width(10); std::cout << generator_name(r.family) << ' ';
+		std::cout.width(11); std::cout << size.str() << std::right;
+		std::cout.width(7); std::cout << r.size.count;
+		for (double value : {r.times.mean, r.times.p50, r.times.p90, r.times.p99, r.times.max}) {
+			std::cout.width(13);
+			std::cout << value;
+		}
+		std::cout.width(10); std::cout << r.times.outliers;
+		std::cout.width(12); std::cout << r.throughput;
+		std::cout.width(10); std::cout << r.peakRSS;
+		std::cout.width(12); std::cout << r.mismatches;
+		std::cout.width(13);
+		if (r.uncertified < 0) std::cout << "-\n";
+		else std::cout << r.uncertified << '\n';
+	}
+}
+
+void printCSV(const std::vector<Result> & results) {
+	std::cout << "solver,family,width,height,count,mean_s,p50_s,p90_s,p99_s,max_s,outliers,solves_per_s,peak_rss_kib,mismatches,uncertified\n";
+	for (const auto & r : results) {
+		std::cout << r.solver << ',' << generator_name(r.family) << ',' << r.size.width << ',' << r.size.height << ',' << r.size.count << ','
+		          << r.times.mean << ',' << r.times.p50 << ',' << r.times.p90 << ',' << r.times.p99 << ',' << r.times.max << ','
+		          << r.times.outliers << ',' << r.throughput << ',' << r.peakRSS << ',' << r.mismatches << ',';
+		if (r.uncertified >= 0) std::cout << r.uncertified;
+		std::cout << '\n';
+	}
+}
+
+void printJSON(const std::vector<Result> & results) {
+	std::cout << "[\n";
+	for (size_t i = 0; i < results.size(); ++i) {
+		const auto & r = results[i];
+		std::cout << "  {\"solver\": \"" << r.solver << "\", \"family\": \"" << generator_name(r.family)
+		          << "\", \"width\": " << r.size.width
+		          << ", \"height\": " << r.size.height << ", \"count\": " << r.size.count
+		          << ", \"mean_s\": " << r.times.mean << ", \"p50_s\": " << r.times.p50 << ", \"p90_s\": " << r.times.p90
+		          << ", \"p99_s\": " << r.times.p99 << ", \"max_s\": " << r.times.max << ", \"outliers\": " << r.times.outliers
+		          << ", \"solves_per_s\": " << r.throughput << ", \"peak_rss_kib\": " << r.peakRSS
+		          << ", \"mismatches\": " << r.mismatches << ", \"uncertified\": ";
+		if (r.uncertified < 0) std::cout << "null";
+		else std::cout << r.uncertified;
+		std::cout << '}' << (i + 1 < results.size() ? "," : "") << '\n';
+	}
+	std::cout << "]\n";
+}
+
+
+// Fits mean time = c * size^k to the results of one solver, family, and
+// aspect ratio, by least squares on the logs. `results` is in increasing size.
+Fit fit(const std::vector<Result> & results, const size_t aspectWidth, const size_t aspectHeight) {
+	Fit fit;
+	fit.solver = results.front().solver;
+	fit.family = results.front().family;
+	fit.aspectWidth = aspectWidth;
+	fit.aspectHeight = aspectHeight;
+	fit.from = fit.to = 0;
+	fit.exponent = NAN;
+
+	std::vector<std::pair<double, double>> points;
+	for (const auto & r : results) {
+		if (r.times.mean < FIT_MIN_TIME) continue;
+		const size_t size = std::max(r.size.width, r.size.height);
+		if (!fit.from) fit.from = size;
+		fit.to = size;
+		points.emplace_back(std::log(double(size)), std::log(r.times.mean));
+	}
+	if (points.size() < 2) return fit;
+
+	double meanX = 0, meanY = 0;
+	for (const auto & point : points) {
+		meanX += point.first;
+		meanY += point.second;
+	}
+	meanX /= points.size();
+	meanY /= points.size();
+
+	double covariance = 0, variance = 0;
+	for (const auto & point : points) {
+		covariance += (point.first - meanX) * (point.second - meanY);
+		variance += (point.first - meanX) * (point.first - meanX);
+	}
+	fit.exponent = covariance / variance;
+
+	return fit;
+}
+
+bool superCubic(const Fit & fit) {
+	return fit.exponent > 3 + FIT_TOLERANCE;
+}
+
+void printFitsText(const std::vector<Fit> & fits) {
+	const size_t nameWidth = solverWidth(fits);
+	std::cout << '\n';
+	std::cout.width(nameWidth); std::cout << std::left << "solver";
+	std::cout << " family     aspect  sizes        exponent\n";
+	for (const auto & f : fits) {
+		std::ostringstream aspect, sizes;
+		aspect << f.aspectWidth << 'x' << f.aspectHeight;
+		sizes << f.from << '-' << f.to;
+
+		std::cout.width(nameWidth); std::cout << std::left << f.solver << ' ';
+		std::cout.width(10); std::cout << generator_name(f.family) << ' ';
+		std::cout.width(7); std::cout << aspect.str() << ' ';
+		std::cout.width(12); std::cout << sizes.str() << std::right;
+		if (std::isnan(f.exponent)) std::cout << "       -\n";
+		else {
+			std::cout.width(8); std::cout << std::fixed;
+			std::cout.precision(2); std::cout << f.exponent;
+			std::cout.unsetf(std::ios::floatfield);
+			std::cout.precision(6);
+			std::cout << (superCubic(f) ? "  worse than O(n^3)\n" : "\n");
+		}
+	}
+}
+
+void printFitsCSV(const std::vector<Fit> & fits) {
+	std::cout << "\nsolver,family,aspect_width,aspect_height,from,to,exponent,super_cubic\n";
+	for (const auto & f : fits) {
+		std::cout << f.solver << ',' << generator_name(f.family) << ',' << f.aspectWidth << ',' << f.aspectHeight << ','
+		          << f.from << ',' << f.to << ',';
+		if (!std::isnan(f.exponent)) std::cout << f.exponent;
+		std::cout << ',' << (superCubic(f) ? "true" : "false") << '\n';
+	}
+}
+
+void printFitsJSON(const std::vector<Fit> & fits) {
+	std::cout << "[\n";
+	for (size_t i = 0; i < fits.size(); ++i) {
+		const auto & f = fits[i];
+		std::cout << "  {\"solver\": \"" << f.solver << "\", \"family\": \"" << generator_name(f.family)
+		          << "\", \"aspect_width\": " << f.aspectWidth << ", \"aspect_height\": " << f.aspectHeight
+		          << ", \"from\": " << f.from << ", \"to\": " << f.to << ", \"exponent\": ";
+		if (std::isnan(f.exponent)) std::cout << "null";
+		else std::cout << f.exponent;
+		std::cout << ", \"super_cubic\": " << (superCubic(f) ? "true" : "false") << '}'
+		          << (i + 1 < fits.size() ? "," : "") << '\n';
+	}
+	std::cout << "]\n";
+}
+
+
+int usage() {
+	std::cerr << "Usage: bench [--solvers A,B,...] [--families A,B,...|all] [--seed N] [--format text|csv|json] [--certify]\n"
+	          << "             [WIDTHxHEIGHTxCOUNT ... | --sweep MIN-MAX [--aspects WxH,...] [--budget SECONDS]]\n";
+	return 1;
+}
+
+int main(int argc, char ** argv) {
+	std::vector<std::unique_ptr<Solver>> solvers = allSolvers();
+	std::vector<GeneratorFamily> families = {GENERATOR_UNIFORM};
+	std::vector<Size> sizes;
+	std::vector<std::pair<size_t, size_t>> aspects = {{1, 1}, {4, 1}, {1, 4}};
+	size_t sweepMin = 0, sweepMax = 0;
+	double budget = 5;
+	unsigned long long seed = 1;
+	std::string format = "text";
+	bool certifying = false;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+
+		if (arg == "--solvers" && i + 1 < argc) {
+			std::vector<std::unique_ptr<Solver>> chosen;
+			std::istringstream list(argv[++i]);
+			std::string name;
+			while (std::getline(list, name, ',')) {
+				auto solver = std::find_if(solvers.begin(), solvers.end(), [&](const std::unique_ptr<Solver> & s){ return s && name == s->name(); });
+				if (solver == solvers.end()) {
+					std::cerr << "Unknown solver: " << name << '\n';
+					return 1;
+				}
+				chosen.push_back(std::move(*solver));
+			}
+			solvers = std::move(chosen);
+		} else if (arg == "--families" && i + 1 < argc) {
+			families.clear();
+			std::istringstream list(argv[++i]);
+			std::string name;
+			while (std::getline(list, name, ',')) {
+				if (name == "all") {
+					for (int family = 0; family < GENERATOR_FAMILIES; ++family)
+						families.push_back(GeneratorFamily(family));
+				} else if (generator_parse(name.c_str()) != GENERATOR_FAMILIES) {
+					families.push_back(generator_parse(name.c_str()));
+				} else {
+					std::cerr << "Unknown family: " << name << '\n';
+					return 1;
+				}
+			}
+		} else if (arg == "--sweep" && i + 1 < argc) {
+			if (std::sscanf(argv[++i], "%zu-%zu", &sweepMin, &sweepMax) != 2 || !sweepMin || sweepMin > sweepMax)
+				return usage();
+		} else if (arg == "--aspects" && i + 1 < argc) {
+			aspects.clear();
+			std::istringstream list(argv[++i]);
+			std::string aspect;
+			while (std::getline(list, aspect, ',')) {
+				size_t width, height;
+				if (std::sscanf(aspect.c_str(), "%zux%zu", &width, &height) != 2 || !width || !height)
+					return usage();
+				aspects.emplace_back(width, height);
+			}
+		} else if (arg == "--budget" && i + 1 < argc) {
+			budget = std::stod(argv[++i]);
+		} else if (arg == "--seed" && i + 1 < argc) {
+			seed = std::stoull(argv[++i]);
+		} else if (arg == "--certify") {
+			certifying = true;
+		} else if (arg == "--format" && i + 1 < argc) {
+			format = argv[++i];
+			if (format != "text" && format != "csv" && format != "json") return usage();
+		} else {
+			Size size;
+			if (std::sscanf(argv[i], "%zux%zux%zu", &size.width, &size.height, &size.count) != 3 || !size.width || !size.height || !size.count)
+				return usage();
+			sizes.push_back(size);
+		}
+	}
+
+	if (sweepMin && !sizes.empty()) return usage();
+	if (!sweepMin && sizes.empty()) sizes = {{50, 50, 10000}, {250, 250, 100}, {1000, 1000, 10}};
+
+	std::vector<Result> results;
+	std::vector<Fit> fits;
+
+	// Runs every solver that has not gone over the budget on one size.
+	auto runSize = [&](const GeneratorFamily family, const Size & size, std::vector<std::vector<Result>> * sweeps) {
+		std::vector<unsigned long long> referenceCosts;
+		for (size_t i = 0; i < solvers.size(); ++i) {
+			if (sweeps && !(*sweeps)[i].empty() && (*sweeps)[i].back().times.mean > budget) continue;
+
+			results.push_back(run(*solvers[i], family, size, seed, referenceCosts, sweeps ? budget : 0, certifying));
+			if (sweeps) (*sweeps)[i].push_back(results.back());
+			if (results.back().mismatches)
+				std::cerr << solvers[i]->name() << " disagreed with the first solver on "
+				          << results.back().mismatches << " of " << results.back().size.count << ' ' << size.width << 'x' << size.height
+				          << ' ' << generator_name(family) << " matrices\n";
+			if (results.back().uncertified > 0)
+				std::cerr << solvers[i]->name() << "'s potentials did not certify "
+				          << results.back().uncertified << " of " << results.back().size.count << ' ' << size.width << 'x' << size.height
+				          << ' ' << generator_name(family) << " solutions\n";
+		}
+	};
+
+	for (const auto family : families) {
+		if (!sweepMin) {
+			for (const auto & size : sizes)
+				runSize(family, size, nullptr);
+			continue;
+		}
+
+		for (const auto & aspect : aspects) {
+			std::vector<std::vector<Result>> sweeps(solvers.size());
+
+			for (size_t n = sweepMin; n <= sweepMax; n *= 2) {
+				const size_t larger = std::max(aspect.first, aspect.second);
+				Size size;
+				size.width = std::max(n * aspect.first / larger, size_t(1));
+				size.height = std::max(n * aspect.second / larger, size_t(1));
+				size.count = std::max(size_t(3), std::min(size_t(1000), (size_t(1) << 22) / (n * n)));
+				runSize(family, size, &sweeps);
+			}
+
+			for (const auto & sweep : sweeps)
+				if (!sweep.empty())
+					fits.push_back(fit(sweep, aspect.first, aspect.second));
+		}
+	}
+
+	if (format == "csv") {
+		printCSV(results);
+		if (sweepMin) printFitsCSV(fits);
+	} else if (format == "json") {
+		if (sweepMin) std::cout << "{\"results\":\n";
+		printJSON(results);
+		if (sweepMin) {
+			std::cout << ",\"fits\":\n";
+			printFitsJSON(fits);
+			std::cout << "}\n";
+		}
+	} else {
+		printText(results);
+		if (sweepMin) printFitsText(fits);
+	}
+
+	for (const auto & f : fits)
+		if (superCubic(f))
+			std::cerr << f.solver << " is worse than O(n^3) on " << generator_name(f.family) << ' '
+			          << f.aspectWidth << 'x' << f.aspectHeight << " matrices (n^" << f.exponent << ")\n";
+}
@@ -0,0 +1,89 @@
+/*
+Checks that an assignment is optimal, using the dual potentials of a solver.
+
+For a matrix with no more rows than columns, the assignment problem is the
+linear program
+	minimize the sum of cost[row][column] * x[row][column]
+	where every row sums to 1, every column sums to at most 1, and x >= 0,
+and its dual is
+	maximize the sum of u[row] + the sum of v[column]
+	where u[row] + v[column] <= cost[row][column] and v[column] <= 0.
+An assignment and a pair of potentials u and v are both optimal if
+- every row is assigned, and no column is assigned twice,
+- every reduced cost, cost[row][column] - u[row] - v[column], is at least 0,
+- the reduced cost of every assigned cell is 0, and
+- v is at most 0, and is 0 for every unassigned column.
+Matrices with more rows than columns are the same, with rows and columns
+swapped. For a square matrix, the last rule does not apply.
+
+Checking this reads every cell once, so it is much faster than solving, and
+it does not need another solver to compare against. It is only a proof if the
+potentials are exact, which they are for integer costs that are small enough.
+*/
+
+#pragma once
+
+
+#ifndef CERTIFY
+#define CERTIFY
+
+
+#include <vector>
+#include <cstddef>
+
+
+// Returns nullptr if `rowPotentials` and `columnPotentials` prove that
+// `columns` (the column assigned to each row, or `none`) is an optimal
+// assignment for the `width` x `height` row-major `costs`. Otherwise returns
+// the first rule that is broken.
+template<typename Cost>
+const char * certify(const std::vector<Cost> & costs, const size_t width, const size_t height,
+                     const std::vector<size_t> & columns, const size_t none,
+                     const std::vector<long long> & rowPotentials, const std::vector<long long> & columnPotentials) {
+	if (columns.size() != height || rowPotentials.size() != height || columnPotentials.size() != width)
+		return "wrong number of results";
+
+	std::vector<char> rowUsed(height, false), columnUsed(width, false);
+	size_t assigned = 0;
+
+	for (size_t row = 0; row < height; ++row) {
+		const size_t column = columns[row];
+		if (column == none) continue;
+		if (column >= width || columnUsed[column]) return "invalid assignment";
+
+		rowUsed[row] = columnUsed[column] = true;
+		++assigned;
+	}
+	if (assigned != (width < height ? width : height)) return "not every line is assigned";
+
+	// The potentials of the longer side must be at most 0, and exactly 0
+	// where that side is not assigned.
+	if (height < width) {
+		for (size_t column = 0; column < width; ++column) {
+			if (columnPotentials[column] > 0) return "positive column potential";
+			if (!columnUsed[column] && columnPotentials[column] != 0) return "unassigned column has a potential";
+		}
+	} else if (width < height) {
+		for (size_t row = 0; row < height; ++row) {
+			if (rowPotentials[row] > 0) return "positive row potential";
+			if (!rowUsed[row] && rowPotentials[row] != 0) return "unassigned row has a potential";
+		}
+	}
+
+	// 128 bits, so that the sums of the potentials cannot overflow.
+	for (size_t row = 0; row < height; ++row) {
+		const Cost * const rowCosts = &costs[row*width];
+		const __int128 u = rowPotentials[row];
+
+		for (size_t column = 0; column < width; ++column) {
+			const __int128 reduced = __int128(rowCosts[column]) - u - columnPotentials[column];
+			if (reduced < 0) return "negative reduced cost";
+			if (reduced != 0 && columns[row] == column) return "assigned cell has a reduced cost";
+		}
+	}
+
+	return nullptr;
+}
+
+
+#endif /* CERTIFY */
@@ -0,0 +1,344 @@
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <limits>
+#ifndef APS_POTENTIALS
+#define APS_POTENTIALS
+#endif
+#include "Solvers.h"
+#include "generators.h"
+#include "certify.h"
+
+
+// Checks every solver against an exact oracle and against each other.
+//
+// Usage: fuzz [--solvers A,B,...] [--seed N] [--iterations N] [--large N]
+//
+// Each iteration makes a matrix from a random family in generators.h or from
+// one of the edge cases below, with a random width and height.
+// - Most matrices have one side of at most ORACLE_MAX and the other of at most
+//   WIDE_MAX, and are checked against a dynamic program over the subsets of the
+//   narrower side, which is always right. The wider side is big enough that
+//   the APSO does not use its small solvers on all of them.
+// - Every --large iterations (100 by default), a matrix of up to 200 x 200 is
+//   made instead, and the solvers are compared to each other.
+// Every assignment is also checked: each row and column is used at most once,
+// and min(width, height) cells are assigned. Solvers with dual potentials must
+// also prove their assignment is optimal with them (see certify.h).
+//
+// When a solver fails, its matrix is shrunk as much as possible while it still
+// fails, by removing rows and columns and making costs smaller. Then the
+// smallest matrix is printed. The exit status is the number of failures, up
+// to 100.
+
+
+constexpr size_t ORACLE_MAX = 12;
+constexpr size_t WIDE_MAX = 40;
+
+constexpr Cost INVALID = std::numeric_limits<Cost>::max();
+constexpr Cost UNCERTIFIED = INVALID - 1;
+
+
+struct Matrix2D {
+	std::vector<Cost> costs;
+	size_t width, height;
+
+	Cost & operator()(size_t row, size_t column) { return costs[row*width+column]; }
+	Cost operator()(size_t row, size_t column) const { return costs[row*width+column]; }
+};
+
+
+// The edge cases, on top of the families in generators.h.
+enum EdgeCase { ALL_ZERO, ALL_EQUAL, ONE_NONZERO, LARGE_COSTS, EDGE_CASES };
+
+const char * edgeCaseName(const int edgeCase) {
+	static const char * const names[] = {"all zero", "all equal", "one nonzero", "large costs"};
+	return names[edgeCase];
+}
+
+void makeEdgeCase(Matrix2D & matrix, const int edgeCase, uint64_t & state) {
+	for (auto & cost : matrix.costs) {
+		switch (edgeCase) {
+			case ALL_ZERO: cost = 0; break;
+			case ALL_EQUAL: cost = 7; break;
+			case ONE_NONZERO: cost = 0; break;
+			case LARGE_COSTS: cost = Cost(generator_next(&state) >> 24); break; // up to 2^40
+		}
+	}
+	if (edgeCase == ONE_NONZERO)
+		matrix.costs[generator_below(&state, matrix.costs.size())] = 1;
+}
+
+
+// The minimum total cost, found by dynamic programming over the subsets of the
+// narrower side. The lines of the wider side are added one at a time, and
+// best[subset] is the cheapest way to assign `subset` of the narrower side to
+// the lines added so far. Going through the subsets from the largest down lets
+// it be updated in place, like a 0/1 knapsack.
+unsigned long long oracle(const Matrix2D & matrix) {
+	const bool tall = matrix.height > matrix.width;
+	const size_t narrow = tall ? matrix.width : matrix.height;
+	const size_t wide = tall ? matrix.height : matrix.width;
+	const unsigned long long UNSET = std::numeric_limits<unsigned long long>::max();
+
+	std::vector<unsigned long long> best(size_t(1) << narrow, UNSET);
+	best[0] = 0;
+
+	for (size_t line = 0; line < wide; ++line) {
+		for (size_t subset = best.size(); subset-- > 1;) {
+			for (size_t item = 0; item < narrow; ++item) {
+				const size_t without = subset ^ (size_t(1) << item);
+				if (without > subset || best[without] == UNSET) continue;
+
+				const Cost cost = tall ? matrix(line, item) : matrix(item, line);
+				best[subset] = std::min(best[subset], best[without] + cost);
+			}
+		}
+	}
+
+	return best.back();
+}
+
+// Returns the total cost of the solver's assignment, or INVALID if it is not a
+// valid assignment.
+unsigned long long check(const Matrix2D & matrix, const std::vector<size_t> & columns) {
+	if (columns.size() != matrix.height) return INVALID;
+
+	std::vector<char> used(matrix.width, false);
+	unsigned long long cost = 0;
+	size_t assigned = 0;
+
+	for (size_t row = 0; row < matrix.height; ++row) {
+		const size_t column = columns[row];
+		if (column == NONE) continue;
+		if (column >= matrix.width || used[column]) return INVALID;
+
+		used[column] = true;
+		cost += matrix(row, column);
+		++assigned;
+	}
+
+	return assigned == std::min(matrix.width, matrix.height) ? cost : INVALID;
+}
+
+// Solves the matrix and returns the cost of the assignment found, INVALID if
+// it is not valid, or UNCERTIFIED if the solver's potentials do not prove it is
+// optimal. Then `problem` is set to why they do not.
+unsigned long long solve(Solver & solver, const Matrix2D & matrix, const char ** problem = nullptr) {
+	solver.load(matrix.costs, matrix.width, matrix.height);
+	solver.solve();
+
+	const std::vector<size_t> columns = solver.columns();
+	const unsigned long long cost = check(matrix, columns);
+	if (cost == INVALID) return INVALID;
+
+	std::vector<long long> rowPotentials, columnPotentials;
+	if (solver.potentials(rowPotentials, columnPotentials)) {
+		const char * const reason = certify(matrix.costs, matrix.width, matrix.height, columns, NONE, rowPotentials, columnPotentials);
+		if (reason) {
+			if (problem) *problem = reason;
+			return UNCERTIFIED;
+		}
+	}
+
+	return cost;
+}
+
+
+// Whether `solver` still fails on `matrix`, compared to the oracle if the
+// matrix is small enough, or else to `reference`.
+bool fails(Solver & solver, Solver * reference, const Matrix2D & matrix) {
+	const unsigned long long cost = solve(solver, matrix);
+	if (cost == INVALID || cost == UNCERTIFIED) return true;
+
+	if (std::min(matrix.width, matrix.height) <= ORACLE_MAX)
+		return cost != oracle(matrix);
+	return reference && cost != solve(*reference, matrix);
+}
+
+// Shrinks a failing matrix by removing rows and columns and by making costs
+// smaller, keeping each change only if the solver still fails.
+Matrix2D minimize(Solver & solver, Solver * reference, Matrix2D matrix) {
+	bool changed = true;
+
+	while (changed) {
+		changed = false;
+
+		for (size_t row = 0; row < matrix.height && matrix.height > 1; ++row) {
+			Matrix2D smaller = matrix;
+			smaller.height -= 1;
+			smaller.costs.erase(smaller.costs.begin() + row*matrix.width, smaller.costs.begin() + (row+1)*matrix.width);
+			if (fails(solver, reference, smaller)) {
+				matrix = smaller;
+				changed = true;
+				--row;
+			}
+		}
+
+		for (size_t column = 0; column < matrix.width && matrix.width > 1; ++column) {
+			Matrix2D smaller;
+			smaller.width = matrix.width - 1;
+			smaller.height = matrix.height;
+			for (size_t row = 0; row < matrix.height; ++row)
+				for (size_t c = 0; c < matrix.width; ++c)
+					if (c != column) smaller.costs.push_back(matrix(row, c));
+			if (fails(solver, reference, smaller)) {
+				matrix = smaller;
+				changed = true;
+				--column;
+			}
+		}
+
+		for (auto & cost : matrix.costs) { // halve each cost, or else subtract one
+			while (cost) {
+				const Cost old = cost;
+
+				cost = old / 2;
+				if (fails(solver, reference, matrix)) {
+					changed = true;
+					continue;
+				}
+
+				cost = old - 1;
+				if (old > 1 && fails(solver, reference, matrix)) {
+					changed = true;
+					continue;
+				}
+
+				cost = old;
+				break;
+			}
+		}
+	}
+
+	return matrix;
+}
+
+
+void printMatrix(const Matrix2D & matrix) {
+	for (size_t row = 0; row < matrix.height; ++row) {
+		for (size_t column = 0; column < matrix.width; ++column) {
+			std::cerr.width(4);
+			std::cerr << matrix(row, column) << (column + 1 < matrix.width ? "," : "\n");
+		}
+	}
+}
+
+
+int usage() {
+	std::cerr << "Usage: fuzz [--solvers A,B,...] [--seed N] [--iterations N] [--large N]\n";
+	return 100;
+}
+
+int main(int argc, char ** argv) {
+	std::vector<std::unique_ptr<Solver>> solvers = allSolvers();
+	unsigned long long seed = 1;
+	size_t iterations = 100000, large = 100;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+
+		if (arg == "--solvers" && i + 1 < argc) {
+			std::vector<std::unique_ptr<Solver>> chosen;
+			std::istringstream list(argv[++i]);
+			std::string name;
+			while (std::getline(list, name, ',')) {
+				auto solver = std::find_if(solvers.begin(), solvers.end(), [&](const std::unique_ptr<Solver> & s){ return s && name == s->name(); });
+				if (solver == solvers.end()) {
+					std::cerr << "Unknown solver: " << name << '\n';
+					return usage();
+				}
+				chosen.push_back(std::move(*solver));
+			}
+			solvers = std::move(chosen);
+		} else if (arg == "--seed" && i + 1 < argc) {
+			seed = std::stoull(argv[++i]);
+		} else if (arg == "--iterations" && i + 1 < argc) {
+			iterations = std::stoull(argv[++i]);
+		} else if (arg == "--large" && i + 1 < argc) {
+			large = std::stoull(argv[++i]);
+		} else return usage();
+	}
+
+	if (solvers.empty()) return usage();
+
+	size_t failures = 0;
+	std::vector<size_t> failuresOf(solvers.size(), 0);
+
+	for (size_t iteration = 0; iteration < iterations; ++iteration) {
+		uint64_t state = generator_mix(seed, iteration);
+		const bool isLarge = large && iteration % large == large - 1;
+
+		Matrix2D matrix;
+		if (isLarge) {
+			matrix.width = 1 + generator_below(&state, 200);
+			matrix.height = 1 + generator_below(&state, 200);
+		} else {
+			matrix.width = 1 + generator_below(&state, ORACLE_MAX);
+			matrix.height = 1 + generator_below(&state, WIDE_MAX);
+			if (generator_next(&state) & 1) std::swap(matrix.width, matrix.height);
+		}
+		matrix.costs.resize(matrix.width * matrix.height);
+
+		const int kind = int(generator_below(&state, GENERATOR_FAMILIES + EDGE_CASES));
+		std::string kindName;
+		if (kind < GENERATOR_FAMILIES) {
+			generator_fill(GeneratorFamily(kind), generator_next(&state), matrix.width, matrix.height, matrix.costs.data());
+			kindName = generator_name(GeneratorFamily(kind));
+		} else {
+			makeEdgeCase(matrix, kind - GENERATOR_FAMILIES, state);
+			kindName = edgeCaseName(kind - GENERATOR_FAMILIES);
+		}
+
+		// The expected cost is the oracle's if it can be used. Otherwise it
+		// is the cost most of the solvers agree on.
+		std::vector<unsigned long long> costs;
+		std::vector<const char *> problems(solvers.size(), nullptr);
+		for (size_t i = 0; i < solvers.size(); ++i)
+			costs.push_back(solve(*solvers[i], matrix, &problems[i]));
+
+		unsigned long long expected;
+		if (std::min(matrix.width, matrix.height) <= ORACLE_MAX) expected = oracle(matrix);
+		else {
+			expected = INVALID;
+			size_t votes = 0;
+			for (const auto cost : costs) {
+				const size_t count = std::count(costs.begin(), costs.end(), cost);
+				if (cost != INVALID && cost != UNCERTIFIED && count > votes) {
+					expected = cost;
+					votes = count;
+				}
+			}
+		}
+
+		for (size_t i = 0; i < solvers.size(); ++i) {
+			if (costs[i] == expected) continue;
+
+			++failures;
+			if (failuresOf[i]++) continue; // only minimize each solver's first failure
+
+			// For large matrices, compare against a solver that got it right.
+			Solver * reference = nullptr;
+			for (size_t j = 0; j < solvers.size(); ++j)
+				if (costs[j] == expected) reference = solvers[j].get();
+
+			std::cerr << solvers[i]->name() << " failed on iteration " << iteration << " (" << kindName << ' '
+			          << matrix.width << 'x' << matrix.height << "): ";
+			if (costs[i] == INVALID) std::cerr << "invalid assignment\n";
+			else if (costs[i] == UNCERTIFIED) std::cerr << "potentials do not certify the assignment: " << problems[i] << '\n';
+			else std::cerr << "cost " << costs[i] << " instead of " << expected << '\n';
+
+			const Matrix2D smallest = minimize(*solvers[i], reference, matrix);
+			std::cerr << "Smallest failing matrix (" << smallest.width << 'x' << smallest.height << "):\n";
+			printMatrix(smallest);
+			std::cerr << '\n';
+		}
+	}
+
+	for (size_t i = 0; i < solvers.size(); ++i)
+		std::cout << solvers[i]->name() << ": " << failuresOf[i] << " failures in " << iterations << " iterations\n";
+
+	return int(std::min(failures, size_t(100)));
+}
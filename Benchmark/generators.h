@@ -0,0 +1,186 @@
+/*
+Seeded cost matrix generators for the C and C++ test programs.
+
+Uniform random costs are the easiest case for Hungarian style solvers, so these
+also make the kinds of matrices that real inputs look like, and the kinds that
+make solvers chase zeros:
+
+uniform    Costs uniformly random in [0, width * height], like the original
+           speed tests.
+euclidean  Each row and each column is a random point in a 10000 x 10000
+           square, and each cost is the rounded distance between its row's
+           point and its column's point.
+lowrange   Costs uniformly random in [0, 10], so there are many ties.
+product    The cost of row i and column j is (i + 1) * (j + 1), with the rows
+           and columns shuffled. Every row and column has a different minimum,
+           and the only optimal assignment pairs the largest rows with the
+           smallest columns.
+zeros      Like the specific tests in the README: a random two fifths of the
+           rows and two fifths of the columns are all zeros, and the rest of
+           the costs are random in [1, width * height]. There are zeros
+           everywhere, but not enough independent ones.
+blocks     The rows and the columns are shuffled and split into 8 blocks
+           each, and row block i goes with column block i. Costs inside a
+           block are random in [0, width * height], and costs outside of the
+           blocks are random in [width * height + 1, 2 * width * height + 1],
+           so the blocks can be solved on their own (see APSComponents.h).
+
+generator_fill() fills a row-major matrix, and the same family, seed, and size
+always give the same matrix, on every platform. Use generator_mix() to make a
+seed for each matrix of a test out of a base seed and the matrix's index.
+*/
+
+#ifndef GENERATORS_H
+#define GENERATORS_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+typedef enum {
+	GENERATOR_UNIFORM,
+	GENERATOR_EUCLIDEAN,
+	GENERATOR_LOWRANGE,
+	GENERATOR_PRODUCT,
+	GENERATOR_ZEROS,
+	GENERATOR_BLOCKS,
+	GENERATOR_FAMILIES /* the number of families */
+} GeneratorFamily;
+
+
+/* Returns the name of a family, as it is given on the command line. */
+static inline const char * generator_name(GeneratorFamily family) {
+	static const char * const names[GENERATOR_FAMILIES] = {"uniform", "euclidean", "lowrange", "product", "zeros", "blocks"};
+	return names[family];
+}
+
+/* Returns the family with the given name, or GENERATOR_FAMILIES if there is none. */
+static inline GeneratorFamily generator_parse(const char *name) {
+	int family;
+	for (family = 0; family < GENERATOR_FAMILIES; ++family)
+		if (strcmp(name, generator_name((GeneratorFamily)family)) == 0)
+			break;
+	return (GeneratorFamily)family;
+}
+
+
+/* SplitMix64. It is small, fast, and passes BigCrush, which is plenty here. */
+static inline uint64_t generator_next(uint64_t *state) {
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+/* Returns a uniformly random number in [0, n). `n` must not be 0. */
+static inline uint64_t generator_below(uint64_t *state, uint64_t n) {
+	const uint64_t threshold = (0 - n) % n;
+	uint64_t x;
+	do x = generator_next(state);
+	while (x < threshold);
+	return x % n;
+}
+
+/* Combines a seed with another number, such as the index of a matrix. */
+static inline uint64_t generator_mix(uint64_t seed, uint64_t value) {
+	uint64_t state = seed ^ generator_next(&value);
+	return generator_next(&state);
+}
+
+
+/* Shuffles 0 to count - 1 into `order`. */
+static inline void generator_shuffle(uint64_t *state, size_t *order, size_t count) {
+	size_t i;
+	for (i = 0; i < count; ++i)
+		order[i] = i;
+	for (i = count; i > 1; --i) {
+		const size_t j = (size_t)generator_below(state, i);
+		const size_t temp = order[i - 1];
+		order[i - 1] = order[j];
+		order[j] = temp;
+	}
+}
+
+/* Returns the square root of `x`, rounded to the nearest integer. */
+static inline uint64_t generator_sqrt(uint64_t x) {
+	uint64_t root = 0, bit = (uint64_t)1 << 62;
+	while (bit > x) bit >>= 2;
+	while (bit) {
+		if (x >= root + bit) {
+			x -= root + bit;
+			root = (root >> 1) + bit;
+		} else root >>= 1;
+		bit >>= 2;
+	}
+	return x > root ? root + 1 : root;
+}
+
+
+/* Fills `costs` with a `width` x `height` row-major matrix from a family. */
+static inline void generator_fill(GeneratorFamily family, uint64_t seed, size_t width, size_t height, unsigned long *costs) {
+	const size_t size = width * height;
+	const uint64_t range = (uint64_t)size + 1;
+	uint64_t state = seed;
+	size_t row, column, i;
+
+	switch (family) {
+	case GENERATOR_UNIFORM:
+		for (i = 0; i < size; ++i)
+			costs[i] = (unsigned long)generator_below(&state, range);
+		break;
+
+	case GENERATOR_LOWRANGE:
+		for (i = 0; i < size; ++i)
+			costs[i] = (unsigned long)generator_below(&state, 11);
+		break;
+
+	case GENERATOR_EUCLIDEAN: {
+		uint64_t *points = (uint64_t *)malloc((width + height) * 2 * sizeof(uint64_t));
+		for (i = 0; i < (width + height) * 2; ++i)
+			points[i] = generator_below(&state, 10000);
+		for (row = 0; row < height; ++row) {
+			const uint64_t *a = &points[row * 2];
+			for (column = 0; column < width; ++column) {
+				const uint64_t *b = &points[(height + column) * 2];
+				const uint64_t dx = a[0] > b[0] ? a[0] - b[0] : b[0] - a[0];
+				const uint64_t dy = a[1] > b[1] ? a[1] - b[1] : b[1] - a[1];
+				costs[row * width + column] = (unsigned long)generator_sqrt(dx * dx + dy * dy);
+			}
+		}
+		free(points);
+		break;
+	}
+
+	case GENERATOR_PRODUCT:
+	case GENERATOR_ZEROS:
+	case GENERATOR_BLOCKS: {
+		size_t *rows = (size_t *)malloc((width + height) * sizeof(size_t));
+		size_t *columns = rows + height;
+		generator_shuffle(&state, rows, height);
+		generator_shuffle(&state, columns, width);
+
+		for (row = 0; row < height; ++row) {
+			for (column = 0; column < width; ++column) {
+				unsigned long *cost = &costs[row * width + column];
+				if (family == GENERATOR_PRODUCT)
+					*cost = (unsigned long)((rows[row] + 1) * (columns[column] + 1));
+				else if (family == GENERATOR_BLOCKS)
+					*cost = (unsigned long)generator_below(&state, range)
+					      + (rows[row] * 8 / height == columns[column] * 8 / width ? 0 : range);
+				else if (rows[row] < height * 2 / 5 || columns[column] < width * 2 / 5)
+					*cost = 0;
+				else *cost = (unsigned long)generator_below(&state, size) + 1;
+			}
+		}
+		free(rows);
+		break;
+	}
+
+	default:
+		memset(costs, 0, size * sizeof(unsigned long));
+	}
+}
+
+
+#endif /* GENERATORS_H */
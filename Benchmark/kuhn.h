@@ -0,0 +1,32 @@
+/*
+C entry points for the two kuhn_match implementations, so that they can be
+called from the benchmark driver. Each implementation is compiled in its own
+translation unit (kuhn_mattias.c and kuhn_bonzini.c) because they define the
+same names.
+
+Both take a contiguous row-major table that is `n` rows tall and `m` columns
+wide, with n <= m. The table is modified. `columns` is filled with the column
+assigned to each row. The workspace must be at least the size returned by the
+matching *_workspace_size function, and can be reused between solves.
+*/
+
+#ifndef KUHN_H
+#define KUHN_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+size_t mattias_workspace_size(size_t n, size_t m);
+void mattias_solve(long *table, size_t n, size_t m, void *workspace, size_t *columns);
+
+size_t bonzini_workspace_size(size_t n, size_t m);
+void bonzini_solve(size_t *table, size_t n, size_t m, void *workspace, size_t *columns);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KUHN_H */
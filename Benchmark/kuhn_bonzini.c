@@ -0,0 +1,17 @@
+#include "kuhn.h"
+#include "../PaoloBonzini/hungarian.c"
+
+
+size_t bonzini_workspace_size(size_t n, size_t m) {
+	return kuhn_workspaceSize(n, m) + n * sizeof(ssize_t);
+}
+
+void bonzini_solve(size_t *table, size_t n, size_t m, void *workspace, size_t *columns) {
+	/* The assignment is stored after the kuhn_match workspace. */
+	ssize_t *assignment = (ssize_t *)((char *)workspace + kuhn_workspaceSize(n, m));
+
+	kuhn_matchStrided(table, m, n, m, workspace, assignment);
+
+	for (size_t i = 0; i < n; ++i)
+		columns[i] = (size_t)assignment[i];
+}
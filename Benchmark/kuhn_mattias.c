@@ -0,0 +1,22 @@
+#include "kuhn.h"
+
+/* Only kuhn_match_strided is used, so its other static functions are not. */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#include "../MattiasAndrée/hungarian.c"
+#pragma GCC diagnostic pop
+
+
+size_t mattias_workspace_size(size_t n, size_t m) {
+	return kuhn_workspace_size(n, m) + n * sizeof(CellPosition);
+}
+
+void mattias_solve(long *table, size_t n, size_t m, void *workspace, size_t *columns) {
+	/* The assignment is stored after the kuhn_match workspace. */
+	CellPosition *assignment = (CellPosition *)((char *)workspace + kuhn_workspace_size(n, m));
+
+	kuhn_match_strided(n, m, table, m, workspace, assignment);
+
+	for (size_t i = 0; i < n; ++i)
+		columns[assignment[i].row] = assignment[i].col;
+}
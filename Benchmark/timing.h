@@ -0,0 +1,109 @@
+/*
+Wall-clock timing and latency statistics for the C and C++ test programs.
+
+timing_now() reads the monotonic clock in nanoseconds. On Linux this is a vDSO
+call with nanosecond resolution and about 20 ns of overhead, unlike clock(),
+which measures CPU time and can be as coarse as 1 ms. The TSC is not read
+directly because turning cycles into seconds needs calibration, and an
+invariant TSC, which is not guaranteed everywhere these programs run.
+
+timing_summarize() sorts an array of samples (in seconds) and computes the
+mean, percentiles, and the number of outliers. A sample is an outlier if it
+is more than three interquartile ranges above the third quartile.
+
+Include this before any system header, because it needs POSIX's clock_gettime.
+*/
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#if !defined(_POSIX_C_SOURCE) && !defined(__cplusplus)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+
+/* The number of untimed runs to do before timing `count` runs. */
+#define TIMING_WARMUP(count)  ((count) / 10)
+
+
+typedef struct {
+	size_t count;
+	size_t outliers;
+	double mean;
+	double min;
+	double p50;
+	double p90;
+	double p99;
+	double max;
+} TimingSummary;
+
+
+/* Returns the current time of the monotonic clock in nanoseconds. */
+static inline uint64_t timing_now(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/* Returns the number of seconds between two results of timing_now(). */
+static inline double timing_seconds(uint64_t start, uint64_t end) {
+	return (double)(end - start) / 1e9;
+}
+
+
+static inline int timing_compare(const void *a, const void *b) {
+	const double x = *(const double *)a, y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+/* Returns the `p`th percentile of sorted samples, using the nearest rank. */
+static inline double timing_percentile(const double *sorted, size_t count, double p) {
+	size_t rank = (size_t)(p / 100 * (double)count + 0.999999);
+	if (rank < 1) rank = 1;
+	if (rank > count) rank = count;
+	return sorted[rank - 1];
+}
+
+/* Sorts `samples` and summarizes them. `count` must not be 0. */
+static inline TimingSummary timing_summarize(double *samples, size_t count) {
+	TimingSummary summary;
+	double total = 0, fence;
+	size_t i;
+
+	qsort(samples, count, sizeof(double), timing_compare);
+
+	for (i = 0; i < count; ++i)
+		total += samples[i];
+
+	summary.count = count;
+	summary.mean = total / (double)count;
+	summary.min = samples[0];
+	summary.p50 = timing_percentile(samples, count, 50);
+	summary.p90 = timing_percentile(samples, count, 90);
+	summary.p99 = timing_percentile(samples, count, 99);
+	summary.max = samples[count - 1];
+
+	fence = timing_percentile(samples, count, 75);
+	fence += 3 * (fence - timing_percentile(samples, count, 25));
+	summary.outliers = 0;
+	for (i = count; i > 0 && samples[i - 1] > fence; --i)
+		++summary.outliers;
+
+	return summary;
+}
+
+/* Prints a summary the way the test programs report their times. */
+static inline void timing_print(FILE *out, const TimingSummary *summary) {
+	fprintf(out, "%gs Average Time\n", summary->mean);
+	fprintf(out, "%gs p50, %gs p90, %gs p99, %gs max, %lu outlier%s\n",
+	        summary->p50, summary->p90, summary->p99, summary->max,
+	        (unsigned long)summary->outliers, summary->outliers == 1 ? "" : "s");
+}
+
+
+#endif /* TIMING_H */
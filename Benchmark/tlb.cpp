@@ -0,0 +1,169 @@
+#include <iostream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <limits>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "timing.h"
+#include "generators.h"
+#include "../Yay295/APS.h"
+#include "../JohnWeaver/munkres.h"
+
+
+// Counts the data TLB misses and page faults of the APSO and Munkres, which
+// both make full passes over their copy of the matrix, on one matrix of each
+// size. `make time-tlb` builds it twice, as tlb with the default pages, and as
+// tlb-huge with APS_HUGE_PAGES and MATRIX_HUGE_PAGES, and runs both.
+//
+// Usage: tlb [--solvers A,B,...] [--family F] [--seed N] [WIDTHxHEIGHT ...]
+//
+// The solvers are APSO and Munkres (both by default). The matrices are from a
+// family in generators.h (uniform by default), and 1000x1000 by default. The
+// counters only count this process's own code, and are read with
+// perf_event_open(2). Where the data TLB misses can not be counted, such as in
+// most virtual machines, or with /proc/sys/kernel/perf_event_paranoid above 2,
+// they are printed as "-". The page faults are still counted: a fault of a
+// transparent huge page maps 512 pages at once, so they go down by about that
+// much when huge pages are used.
+
+
+#ifdef APS_HUGE_PAGES
+constexpr const char * PAGES = "huge";
+#else
+constexpr const char * PAGES = "default";
+#endif
+
+
+// A counter of this process's user space events. stop() returns -1 if they
+// can not be counted.
+class Counter {
+	int fd;
+
+	public:
+
+	Counter(const uint32_t type, const uint64_t config) {
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = type;
+		attr.config = config;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+	}
+
+	~Counter() { if (fd >= 0) close(fd); }
+
+	Counter(const Counter &) = delete;
+	Counter & operator=(const Counter &) = delete;
+
+	void start() {
+		if (fd < 0) return;
+		ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+	}
+
+	long long stop() {
+		if (fd < 0) return -1;
+		ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+		long long count;
+		return read(fd, &count, sizeof(count)) == ssize_t(sizeof(count)) ? count : -1;
+	}
+};
+
+
+void print(const char * const solver, const size_t width, const size_t height, const double seconds, const long long misses, const long long faults) {
+	const std::string size = std::to_string(width) + 'x' + std::to_string(height);
+	std::printf("%-8s %-10s %-8s %10.4f", solver, size.c_str(), PAGES, seconds);
+	if (misses < 0) std::printf(" %14s", "-");
+	else std::printf(" %14lld", misses);
+	if (faults < 0) std::printf(" %10s\n", "-");
+	else std::printf(" %10lld\n", faults);
+}
+
+int usage() {
+	std::cerr << "Usage: tlb [--solvers A,B,...] [--family F] [--seed N] [WIDTHxHEIGHT ...]\n";
+	return 1;
+}
+
+int main(int argc, char ** argv) {
+	std::vector<std::string> solvers = {"APSO", "Munkres"};
+	GeneratorFamily family = GENERATOR_UNIFORM;
+	unsigned long long seed = 1;
+	std::vector<std::pair<size_t, size_t>> sizes;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		size_t width, height;
+
+		if (arg == "--solvers" && i + 1 < argc) {
+			solvers.clear();
+			std::stringstream list(argv[++i]);
+			for (std::string name; std::getline(list, name, ',');) {
+				if (name != "APSO" && name != "Munkres") return usage();
+				solvers.push_back(name);
+			}
+		} else if (arg == "--family" && i + 1 < argc) {
+			family = generator_parse(argv[++i]);
+			if (family == GENERATOR_FAMILIES) return usage();
+		} else if (arg == "--seed" && i + 1 < argc) {
+			seed = std::stoull(argv[++i]);
+		} else if (std::sscanf(argv[i], "%zux%zu", &width, &height) == 2 && width && height) {
+			sizes.emplace_back(width, height);
+		} else return usage();
+	}
+
+	if (sizes.empty()) sizes = {{1000, 1000}};
+
+	Counter misses(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+	Counter faults(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+
+	std::printf("solver   size       pages     seconds  dTLB misses  page faults\n");
+	for (const auto & size : sizes) {
+		const size_t width = size.first, height = size.second;
+		std::vector<unsigned long> costs(width * height);
+		generator_fill(family, generator_mix(seed, width * height), width, height, costs.data());
+
+		for (const auto & solver : solvers) {
+			uint64_t start;
+			long long missCount, faultCount;
+
+			if (solver == "APSO") {
+				std::vector<uint32_t> values(costs.size());
+				std::transform(costs.begin(), costs.end(), values.begin(),
+				               [](const unsigned long cost) { return uint32_t(std::min<unsigned long>(cost, std::numeric_limits<uint32_t>::max())); });
+
+				start = timing_now();
+				misses.start();
+				faults.start();
+				const APSO apso(values.data(), width, height);
+				faultCount = faults.stop();
+				missCount = misses.stop();
+			} else {
+				Matrix<long> matrix(height, width);
+				for (size_t row = 0; row < height; ++row)
+					for (size_t column = 0; column < width; ++column)
+						matrix(row, column) = long(costs[row*width+column]);
+
+				start = timing_now();
+				misses.start();
+				faults.start();
+				Munkres<long> munkres;
+				munkres.solve(matrix);
+				faultCount = faults.stop();
+				missCount = misses.stop();
+			}
+
+			print(solver.c_str(), width, height, timing_seconds(start, timing_now()), missCount, faultCount);
+		}
+	}
+
+	return 0;
+}
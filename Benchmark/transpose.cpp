@@ -0,0 +1,100 @@
+#include "timing.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include "../Yay295/APS.h"
+
+
+// Times the APSO's transpose alone, which it does to every matrix taller than
+// it is wide, against the column by column walk it used to do.
+//
+// Usage: transpose [--runs N] [WIDTHxHEIGHT ...]
+//
+// Each size (1000x5000, 100x10000, and 4000x8000 by default) is transposed
+// --runs times (20 by default) for each size of value, after some untimed
+// runs, and the median times are printed. The two transposes must give the
+// same matrix.
+
+
+// The old transpose: reading down each column misses the cache on every value
+// once the rows are more than a few kilobytes apart.
+template<typename T>
+void columnTranspose(const T * const input, const size_t width, const size_t height, std::vector<typename std::make_unsigned<T>::type> & output) {
+	typedef typename std::make_unsigned<T>::type U;
+	output.clear();
+	output.reserve(width * height);
+
+	for (size_t column = 0; column < width; ++column)
+		for (size_t row = 0; row < height; ++row)
+			output.push_back(U(U(input[row*width+column]) - U(std::numeric_limits<T>::min())));
+}
+
+template<typename Transpose>
+double median(const size_t runs, Transpose transpose) {
+	std::vector<double> times(runs);
+
+	for (size_t run = 0; run < TIMING_WARMUP(runs) + runs; ++run) {
+		const uint64_t start = timing_now();
+		transpose();
+		if (run >= TIMING_WARMUP(runs)) times[run-TIMING_WARMUP(runs)] = timing_seconds(start, timing_now());
+	}
+
+	return timing_summarize(times.data(), runs).p50;
+}
+
+// Returns whether both transposes gave the same matrix.
+template<typename T>
+bool test(const char * const name, const size_t width, const size_t height, const size_t runs) {
+	std::vector<T> input(width * height);
+	for (size_t i = 0; i < input.size(); ++i)
+		input[i] = T(i * 2654435761u);
+
+	std::vector<typename std::make_unsigned<T>::type> column, blocked;
+	const double columnTime = median(runs, [&]{ columnTranspose(input.data(), width, height, column); });
+	const double blockedTime = median(runs, [&]{ APSO::transposeToUnsigned(input.data(), width, height, blocked); });
+
+	std::printf("%-4s %10.6f %10.6f %8.2fx\n", name, columnTime, blockedTime, columnTime / blockedTime);
+	return column == blocked;
+}
+
+int usage() {
+	std::cerr << "Usage: transpose [--runs N] [WIDTHxHEIGHT ...]\n";
+	return 1;
+}
+
+int main(int argc, char ** argv) {
+	size_t runs = 20;
+	std::vector<std::pair<size_t, size_t>> sizes;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		size_t width, height;
+
+		if (arg == "--runs" && i + 1 < argc) {
+			runs = std::stoull(argv[++i]);
+			if (!runs) return usage();
+		} else if (std::sscanf(argv[i], "%zux%zu", &width, &height) == 2 && width && height) {
+			sizes.emplace_back(width, height);
+		} else return usage();
+	}
+
+	if (sizes.empty()) sizes = {{1000, 5000}, {100, 10000}, {4000, 8000}};
+
+	bool same = true;
+	for (const auto & size : sizes) {
+		std::cout << size.first << 'x' << size.second << "  column (s)  blocked (s)  speedup\n";
+		same &= test<uint8_t>("u8", size.first, size.second, runs);
+		same &= test<uint16_t>("u16", size.first, size.second, runs);
+		same &= test<uint32_t>("u32", size.first, size.second, runs);
+		same &= test<uint64_t>("u64", size.first, size.second, runs);
+		same &= test<int32_t>("i32", size.first, size.second, runs);
+		std::cout << '\n';
+	}
+
+	if (!same) std::cout << "The transposes were different\n";
+	return !same;
+}
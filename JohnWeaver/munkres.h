@@ -23,6 +23,7 @@
 #include "matrix.h"
 
 #include <list>
+#include <vector>
 #include <utility>
 #include <iostream>
 #include <cmath>
@@ -38,6 +39,7 @@ template<typename Data> class Munkres {
 	bool *row_mask;
 	bool *col_mask;
 	size_t saverow = 0, savecol = 0;
+	std::vector<double> row_potential, col_potential;
 
 	public:
 
@@ -52,27 +54,24 @@ template<typename Data> class Munkres {
 	 *
 	 */
 	void solve(Matrix<Data> &m) {
-		const size_t rows = m.rows(), columns = m.columns(), size = std::max(rows,columns);
+		const size_t rows = m.rows(), columns = m.columns();
 
 		// Copy input matrix
 		this->matrix = m;
 
-		if (rows != columns) {
-			// If the input matrix isn't square, make it square
-			// and fill the empty values with the largest value present
-			// in the matrix.
-			matrix.resize(size, size, matrix.max());
-		}
-
+		// Non-square matrices are solved in their original shape. Every
+		// line of the shorter dimension gets exactly one assignment, so only
+		// min(rows, columns) stars have to be found.
 
 		// STAR == 1 == starred, PRIME == 2 == primed
-		mask_matrix.resize(size,size);
+		mask_matrix.resize(rows,columns);
+		mask_matrix.clear();
 
-		row_mask = new bool[size];
-		col_mask = new bool[size];
-		for (size_t i = 0; i < size; ++i)
+		row_mask = new bool[rows];
+		col_mask = new bool[columns];
+		for (size_t i = 0; i < rows; ++i)
 			row_mask[i] = false;
-		for (size_t i = 0; i < size; ++i)
+		for (size_t i = 0; i < columns; ++i)
 			col_mask[i] = false;
 
 		// Prepare the matrix values...
@@ -81,8 +80,16 @@ template<typename Data> class Munkres {
 		// than the maximum value in the matrix.
 		replace_infinites(matrix);
 
-		minimize_along_direction(matrix, rows >= columns);
-		minimize_along_direction(matrix, rows < columns);
+		// The potentials start at zero, and take on everything that is
+		// subtracted from the rows and columns.
+		row_potential.assign(rows, 0);
+		col_potential.assign(columns, 0);
+
+		// Only the shorter dimension may be reduced, because lines along the
+		// longer dimension are not all part of the assignment.
+		minimize_along_direction(matrix, rows >= columns, rows >= columns ? &col_potential : &row_potential);
+		if (rows == columns)
+			minimize_along_direction(matrix, false, &row_potential);
 
 		// Follow the steps
 		int step = 1;
@@ -111,9 +118,26 @@ template<typename Data> class Munkres {
 			}
 		}
 
+		// Step 5 raises the potential of every uncovered column. A column
+		// that is never starred is never covered, so in a wide matrix all the
+		// unassigned columns have the same potential. Moving that amount from
+		// the columns to the rows makes it 0, as optimality requires.
+		if (rows < columns) {
+			for (size_t col = 0; col < columns; ++col) {
+				if (!col_mask[col]) {
+					const double shift = col_potential[col];
+					for (auto &potential : row_potential)
+						potential += shift;
+					for (auto &potential : col_potential)
+						potential -= shift;
+					break;
+				}
+			}
+		}
+
 		// Store results
-		for (size_t row = 0; row < size; ++row) {
-			for (size_t col = 0; col < size; ++col) {
+		for (size_t row = 0; row < rows; ++row) {
+			for (size_t col = 0; col < columns; ++col) {
 				if (mask_matrix(row,col) == STAR)
 					matrix(row,col) = 0;
 				else
@@ -121,10 +145,6 @@ template<typename Data> class Munkres {
 			}
 		}
 
-		// Remove the excess rows or columns that we added to fit the
-		// input to a square matrix.
-		matrix.resize(rows,columns);
-
 		m = matrix;
 
 		delete[] row_mask;
@@ -167,7 +187,24 @@ template<typename Data> class Munkres {
 
 	}
 
-	static void minimize_along_direction(Matrix<Data> &matrix, const bool over_columns) {
+	/*
+	 *
+	 * Dual potentials of the last solve, one per row and one per column.
+	 * matrix(row,col) - row_potentials()[row] - column_potentials()[col]
+	 * is never negative, and is 0 for every assigned cell. The potentials of
+	 * unassigned rows or columns are 0, and the others of the longer
+	 * dimension are at most 0. This proves the assignment is optimal.
+	 *
+	 */
+	const std::vector<double> & row_potentials() const {
+		return row_potential;
+	}
+	const std::vector<double> & column_potentials() const {
+		return col_potential;
+	}
+
+	// Each minimum subtracted is added to potentials, if it is given.
+	static void minimize_along_direction(Matrix<Data> &matrix, const bool over_columns, std::vector<double> *potentials = nullptr) {
 		const size_t outer_size = over_columns ? matrix.columns() : matrix.rows();
 		const size_t inner_size = over_columns ? matrix.rows() : matrix.columns();
 
@@ -189,6 +226,8 @@ template<typename Data> class Munkres {
 					else
 						matrix(i,j) -= min;
 				}
+				if (potentials)
+					(*potentials)[i] += min;
 			}
 		}
 	}
@@ -394,6 +433,7 @@ template<typename Data> class Munkres {
 			if (row_mask[row]) {
 				for (size_t col = 0; col < columns; ++col)
 					matrix(row,col) += h;
+				row_potential[row] -= h;
 			}
 		}
 
@@ -401,6 +441,7 @@ template<typename Data> class Munkres {
 			if (!col_mask[col]) {
 				for (size_t row = 0; row < rows; ++row)
 					matrix(row,col) -= h;
+				col_potential[col] += h;
 			}
 		}
 
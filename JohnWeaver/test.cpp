@@ -1,9 +1,10 @@
-#include <ctime>
 #include <random>
 #include <algorithm>
 #include <vector>
 #include <iostream>
 #include "munkres.h"
+#include "../Benchmark/timing.h"
+#include "../Benchmark/generators.h"
 
 typedef size_t T;
 
@@ -46,21 +47,31 @@ void specificTest() {
 	}
 }
 
-// Calculates the result of `todo` `width` x `height` matrices and averages
-// their execution time.
+// Calculates the result of `todo` `width` x `height` matrices and summarizes
+// their execution times. Some matrices are solved first without being timed.
 void speedTest(const size_t todo, const size_t width, const size_t height) {
 	std::cout << "Speed Test (" << todo << ' ' << width << 'x' << height << "):\n";
 
 	std::random_device rd;
 	std::mt19937 mt(rd());
 	std::uniform_int_distribution<size_t> random(0, T(width * height));
-	clock_t totalTime = 0;
+	std::vector<double> times(todo);
 
 	Matrix<T> mtx(height,width);
-	for (size_t total = 1; total <= todo; ++total) {
+	auto randomize = [&]() {
 		for (size_t row = 0; row < mtx.rows(); ++row)
 			for (size_t column = 0; column < mtx.columns(); ++column)
-				mtx(column,row) = T(random(mt));
+				mtx(row,column) = T(random(mt));
+	};
+
+	for (size_t total = 0; total < TIMING_WARMUP(todo); ++total) {
+		randomize();
+		Munkres<T> m;
+		m.solve(mtx);
+	}
+
+	for (size_t total = 1; total <= todo; ++total) {
+		randomize();
 
 		if (total < 12) std::cout << '\n' << total;
 		else if (total < 100 && total % 12 == 0) std::cout << '\n' << total / 12 << " Dozen";
@@ -70,13 +81,48 @@ void speedTest(const size_t todo, const size_t width, const size_t height) {
 		else if (total % BILLION == 0) std::cout << '\n' << total / BILLION << " Billion";
 
 		Munkres<T> m;
-		clock_t start = clock();
+		const uint64_t start = timing_now();
 		m.solve(mtx);
-		clock_t end = clock();
-		totalTime += end - start;
+		times[total-1] = timing_seconds(start, timing_now());
+	}
+
+	const TimingSummary summary = timing_summarize(times.data(), todo);
+	std::cout << "\n\n";
+	timing_print(stdout, &summary);
+	std::cout << '\n';
+}
+
+// Solves `todo` `size` x `size` matrices of each family in generators.h and
+// summarizes their execution times.
+void familyTest(const size_t todo, const size_t size) {
+	std::cout << "Family Test (" << todo << ' ' << size << 'x' << size << "):\n\n";
+
+	const uint64_t seed = std::random_device()();
+	std::vector<unsigned long> costs(size * size);
+	std::vector<double> times(todo);
+
+	Matrix<T> mtx(size,size);
+	for (int family = 0; family < GENERATOR_FAMILIES; ++family) {
+		const size_t warmup = TIMING_WARMUP(todo);
+
+		for (size_t run = 0; run < warmup + todo; ++run) {
+			generator_fill(GeneratorFamily(family), generator_mix(generator_mix(seed, family), run), size, size, costs.data());
+			for (size_t row = 0; row < size; ++row)
+				for (size_t column = 0; column < size; ++column)
+					mtx(row,column) = T(costs[row*size+column]);
+
+			Munkres<T> m;
+			const uint64_t start = timing_now();
+			m.solve(mtx);
+			if (run >= warmup) times[run-warmup] = timing_seconds(start, timing_now());
+		}
+
+		const TimingSummary summary = timing_summarize(times.data(), todo);
+		std::cout << generator_name(GeneratorFamily(family)) << ":\n";
+		timing_print(stdout, &summary);
 	}
 
-	std::cout << "\n\n" << (totalTime / double(todo)) / CLOCKS_PER_SEC << "s Average Time\n\n";
+	std::cout << '\n';
 }
 
 int main() {
@@ -84,4 +130,8 @@ int main() {
 	speedTest(10000, 50, 50);
 	speedTest(100, 250, 250);
 	speedTest(10, 1000, 1000);
+	speedTest(10, 10000, 100);
+	speedTest(10, 100, 10000);
+	familyTest(1000, 50);
+	familyTest(10, 250);
 }
@@ -0,0 +1,31 @@
+/**
+ * Yay295's Assignment Problem Solver Object, called through JNI from
+ * apsojni.cpp, so that it can be compared with HungarianAlgorithm in the same
+ * JVM, on the same matrices, with the same timer.
+ * <p>
+ *
+ * It takes the same cost matrices as HungarianAlgorithm and returns the same
+ * kind of assignment, so either can be used. The APSO only solves integers, so
+ * every cost must be a whole number of at most 2^53. The native library,
+ * libapsojni.so, is built by `make` in this folder, and is found through
+ * -Djava.library.path.
+ */
+public final class APSO {
+	static {
+		System.loadLibrary("apsojni");
+	}
+
+	private APSO() {}
+
+	/**
+	 * Finds the assignment with the least total cost.
+	 *
+	 * @param costMatrix
+	 *          the cost matrix, where matrix[i][j] holds the cost of assigning
+	 *          worker i to job j. All rows must be the same length, and all
+	 *          costs must be whole numbers of at most 2^53.
+	 * @return the job assigned to each worker, or -1 for workers that are not
+	 *         assigned.
+	 */
+	public static native int[] solve(double[][] costMatrix);
+}
@@ -0,0 +1,272 @@
+/*
+A C++ port of HungarianAlgorithm.java, with the same interface as the APSO in
+Yay295/APS.h: it takes a pointer to a row-major cost matrix, its width, and its
+height, and afterwards `results` has the x and y of each assigned cell, in
+order of y. It is header only.
+
+	HungarianAlgorithm<int> solver(costs, width, height);
+	for (const auto & result : solver.results)
+		...
+
+`solve` solves another matrix with the same object, reusing its buffers, so a
+service solving many matrices of about the same size does not allocate them
+every time.
+
+It works in doubles for float costs and in long longs for integer costs, which
+must fit in one. Float costs must be finite. The algorithm is unchanged: the
+matrix is padded to a square, reduced by its row and column minimums, matched
+greedily on its zeros, and then each unmatched row is matched by growing a tree
+of tight edges from it, keeping the least slack of each column outside the tree
+so that the labels can be raised in O(n) time. The whole solve is O(n^3), where
+n is the larger of the width and height.
+
+
+Copyright (c) 2012 Kevin L. Stern
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+
+#ifndef STERN_HUNGARIAN
+#define STERN_HUNGARIAN
+
+
+#include <vector>
+#include <limits>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+
+
+struct HungarianResult {
+	size_t x, y;
+	HungarianResult(const size_t x, const size_t y) : x(x), y(y) {}
+};
+
+
+template<typename T>
+class HungarianAlgorithm {
+	public:
+
+	typedef typename std::conditional<std::is_floating_point<T>::value, double, long long>::type Value;
+
+	std::vector<HungarianResult> results;
+
+	HungarianAlgorithm() {}
+
+	HungarianAlgorithm(const T * const costs, const size_t width, const size_t height) {
+		solve(costs, width, height);
+	}
+
+	void solve(const T * const costs, const size_t width, const size_t height) {
+		results.clear();
+		if (!width || !height) return;
+
+		load(costs, width, height);
+		reduce();
+		computeInitialFeasibleSolution();
+		greedyMatch();
+
+		for (size_t w = fetchUnmatchedWorker(0); w < dim; w = fetchUnmatchedWorker(w)) {
+			initializePhase(w);
+			executePhase();
+		}
+
+		results.reserve(std::min(width, height));
+		for (size_t w = 0; w < height; ++w)
+			if (matchJobByWorker[w] < width)
+				results.emplace_back(matchJobByWorker[w], w);
+	}
+
+
+	private:
+
+	static constexpr size_t NONE = size_t(-1);
+	static constexpr Value INFINITE = std::numeric_limits<Value>::has_infinity ? std::numeric_limits<Value>::infinity() : std::numeric_limits<Value>::max();
+
+	size_t dim = 0;
+	std::vector<Value> costMatrix, labelByWorker, labelByJob, minSlackValueByJob;
+	std::vector<size_t> minSlackWorkerByJob, matchJobByWorker, matchWorkerByJob, parentWorkerByCommittedJob;
+	std::vector<char> committedWorkers;
+
+	// Copies the costs into a square matrix, padded with zeros.
+	void load(const T * const costs, const size_t width, const size_t height) {
+		dim = std::max(width, height);
+
+		costMatrix.assign(dim * dim, Value(0));
+		for (size_t w = 0; w < height; ++w)
+			for (size_t j = 0; j < width; ++j)
+				costMatrix[w*dim+j] = Value(costs[w*width+j]);
+
+		labelByWorker.assign(dim, Value(0));
+		labelByJob.assign(dim, Value(0));
+		minSlackValueByJob.resize(dim);
+		minSlackWorkerByJob.resize(dim);
+		committedWorkers.resize(dim);
+		parentWorkerByCommittedJob.resize(dim);
+		matchJobByWorker.assign(dim, NONE);
+		matchWorkerByJob.assign(dim, NONE);
+	}
+
+	// Subtracts the smallest cost of each row from the row, and then the
+	// smallest cost of each column from the column. This does not change
+	// which assignments are optimal.
+	void reduce() {
+		for (size_t w = 0; w < dim; ++w) {
+			Value * const row = costMatrix.data() + w * dim;
+			const Value min = *std::min_element(row, row + dim);
+			for (size_t j = 0; j < dim; ++j)
+				row[j] -= min;
+		}
+
+		std::vector<Value> & min = minSlackValueByJob;
+		std::fill(min.begin(), min.end(), INFINITE);
+		for (size_t w = 0; w < dim; ++w) {
+			const Value * const row = costMatrix.data() + w * dim;
+			for (size_t j = 0; j < dim; ++j)
+				min[j] = std::min(min[j], row[j]);
+		}
+		for (size_t w = 0; w < dim; ++w) {
+			Value * const row = costMatrix.data() + w * dim;
+			for (size_t j = 0; j < dim; ++j)
+				row[j] -= min[j];
+		}
+	}
+
+	// Labels the workers with zero and each job with its smallest cost.
+	void computeInitialFeasibleSolution() {
+		std::fill(labelByJob.begin(), labelByJob.end(), INFINITE);
+		for (size_t w = 0; w < dim; ++w) {
+			const Value * const row = costMatrix.data() + w * dim;
+			for (size_t j = 0; j < dim; ++j)
+				labelByJob[j] = std::min(labelByJob[j], row[j]);
+		}
+	}
+
+	// Matches workers to jobs on tight edges, to start with.
+	void greedyMatch() {
+		for (size_t w = 0; w < dim; ++w) {
+			const Value * const row = costMatrix.data() + w * dim;
+			for (size_t j = 0; j < dim; ++j) {
+				if (matchWorkerByJob[j] == NONE && row[j] - labelByWorker[w] - labelByJob[j] == 0) {
+					match(w, j);
+					break;
+				}
+			}
+		}
+	}
+
+	// Returns the first unmatched worker from `w`, or dim if there is none.
+	// Workers are never unmatched once they are matched, so the search can
+	// continue from the last one.
+	size_t fetchUnmatchedWorker(size_t w) const {
+		while (w < dim && matchJobByWorker[w] != NONE) ++w;
+		return w;
+	}
+
+	// Starts a tree of tight edges from worker `w`.
+	void initializePhase(const size_t w) {
+		std::fill(committedWorkers.begin(), committedWorkers.end(), false);
+		std::fill(parentWorkerByCommittedJob.begin(), parentWorkerByCommittedJob.end(), NONE);
+		committedWorkers[w] = true;
+
+		const Value * const row = costMatrix.data() + w * dim;
+		for (size_t j = 0; j < dim; ++j) {
+			minSlackValueByJob[j] = row[j] - labelByWorker[w] - labelByJob[j];
+			minSlackWorkerByJob[j] = w;
+		}
+	}
+
+	// Grows the tree until it reaches an unmatched job, raising the labels
+	// whenever there is no tight edge out of it, and then flips the matching
+	// along the path to that job.
+	void executePhase() {
+		while (true) {
+			size_t minSlackWorker = NONE, minSlackJob = NONE;
+			Value minSlackValue = INFINITE;
+			for (size_t j = 0; j < dim; ++j) {
+				if (parentWorkerByCommittedJob[j] == NONE && minSlackValueByJob[j] < minSlackValue) {
+					minSlackValue = minSlackValueByJob[j];
+					minSlackWorker = minSlackWorkerByJob[j];
+					minSlackJob = j;
+				}
+			}
+
+			if (minSlackValue > 0) updateLabeling(minSlackValue);
+			parentWorkerByCommittedJob[minSlackJob] = minSlackWorker;
+
+			if (matchWorkerByJob[minSlackJob] == NONE) {
+				// An augmenting path has been found.
+				size_t committedJob = minSlackJob;
+				size_t parentWorker = parentWorkerByCommittedJob[committedJob];
+				while (true) {
+					const size_t temp = matchJobByWorker[parentWorker];
+					match(parentWorker, committedJob);
+					committedJob = temp;
+					if (committedJob == NONE) return;
+					parentWorker = parentWorkerByCommittedJob[committedJob];
+				}
+			}
+
+			// Update the slacks for the worker that was added to the tree.
+			const size_t worker = matchWorkerByJob[minSlackJob];
+			committedWorkers[worker] = true;
+			const Value * const row = costMatrix.data() + worker * dim;
+			const Value label = labelByWorker[worker];
+			for (size_t j = 0; j < dim; ++j) {
+				if (parentWorkerByCommittedJob[j] == NONE) {
+					const Value slack = row[j] - label - labelByJob[j];
+					if (minSlackValueByJob[j] > slack) {
+						minSlackValueByJob[j] = slack;
+						minSlackWorkerByJob[j] = worker;
+					}
+				}
+			}
+		}
+	}
+
+	void match(const size_t w, const size_t j) {
+		matchJobByWorker[w] = j;
+		matchWorkerByJob[j] = w;
+	}
+
+	// Adds the slack to the labels of the workers in the tree and subtracts it
+	// from the labels of the jobs in the tree, which keeps every edge in the
+	// tree tight and makes at least one more edge tight.
+	void updateLabeling(const Value slack) {
+		for (size_t w = 0; w < dim; ++w)
+			if (committedWorkers[w])
+				labelByWorker[w] += slack;
+
+		for (size_t j = 0; j < dim; ++j) {
+			if (parentWorkerByCommittedJob[j] != NONE) labelByJob[j] -= slack;
+			else minSlackValueByJob[j] -= slack;
+		}
+	}
+};
+
+// These are used by reference, which needs them to be defined before C++17.
+template<typename T> constexpr size_t HungarianAlgorithm<T>::NONE;
+template<typename T> constexpr typename HungarianAlgorithm<T>::Value HungarianAlgorithm<T>::INFINITE;
+
+
+#endif /* STERN_HUNGARIAN */
@@ -40,9 +40,21 @@ public class Test {
 			int[] result = X.execute();
 			System.out.println("Test " + (i + 1));
 			printResult(result);
+			printResult(APSO.solve(matrices[i]));
 		}
 	}
 
+	private static double total(double[][] matrix, int[] result) {
+		double total = 0;
+		for (int i = 0; i < result.length; ++i)
+			if (result[i] != -1) total += matrix[i][result[i]];
+		return total;
+	}
+
+	// Both solvers are timed on the same matrices with the same timer, so the
+	// times can be compared directly. The APSO's time includes copying the
+	// costs out of the JVM, which HungarianAlgorithm does in its constructor,
+	// before it is timed.
 	private static void speedTest(long todo, long size) {
 		final long THOUSAND = 1000;
 		final long MILLION = THOUSAND * THOUSAND;
@@ -51,7 +63,7 @@ public class Test {
 		System.out.println("== Speed Test (" + todo + ' ' + size + 'x' + size + ") ==\n");
 
 		Random rand = new Random();
-		long totalTime = 0;
+		long totalTime = 0, apsoTime = 0, wrong = 0;
 
 		for (long total = 1; total <= todo; ++total) {
 			double[][] matrix = LongStream.range(0,size).mapToObj(i -> rand.longs(size,0,size*size).asDoubleStream().toArray()).toArray(double[][]::new);
@@ -71,10 +83,20 @@ public class Test {
 			long end = System.nanoTime();
 			totalTime += end - start;
 
+			start = System.nanoTime();
+			int[] apsoResult = APSO.solve(matrix);
+			end = System.nanoTime();
+			apsoTime += end - start;
+
+			if (total(matrix, result) != total(matrix, apsoResult)) ++wrong;
+
 			// printResult(result);
 		}
 
-		System.out.println("\n\n" + (((double)totalTime / (double)todo) / 1000000000.d) + "s Average Time\n\n");
+		System.out.println("\n\n" + (((double)totalTime / (double)todo) / 1000000000.d) + "s Average Time");
+		System.out.println((((double)apsoTime / (double)todo) / 1000000000.d) + "s Average Time (APSO)");
+		if (wrong != 0) System.out.println(wrong + " totals were different");
+		System.out.println("\n");
 	}
 
 	public static void main(String args[]) {
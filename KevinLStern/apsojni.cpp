@@ -0,0 +1,82 @@
+// The native half of APSO.java. It copies the rows of a double[][] to integers
+// and solves them with the C interface in ../Yay295/apso.h, which is compiled
+// into the same library.
+//
+// Nothing is allocated in the JVM except the returned int[]. The buffers are
+// kept per thread between calls, so solving many matrices of about the same
+// size does not allocate them every time.
+
+#include <jni.h>
+
+#include <new>
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include "../Yay295/apso.h"
+
+
+namespace {
+
+// Throws a Java exception of the given class, and returns NULL.
+jintArray raise(JNIEnv * const env, const char * const className, const char * const message) {
+	const jclass exception = env->FindClass(className);
+	if (exception) env->ThrowNew(exception, message);
+	return nullptr;
+}
+
+}
+
+
+extern "C" JNIEXPORT jintArray JNICALL Java_APSO_solve(JNIEnv * const env, jclass, const jobjectArray costMatrix) {
+	if (!costMatrix) return raise(env, "java/lang/NullPointerException", "costMatrix");
+
+	const jsize height = env->GetArrayLength(costMatrix);
+	jsize width = 0;
+
+	thread_local std::vector<jdouble> row;
+	thread_local std::vector<int64_t> costs;
+	thread_local std::vector<int32_t> columns;
+
+	try {
+		for (jsize y = 0; y < height; ++y) {
+			const jdoubleArray rowArray = static_cast<jdoubleArray>(env->GetObjectArrayElement(costMatrix, y));
+			if (!rowArray) return raise(env, "java/lang/NullPointerException", "costMatrix row");
+
+			const jsize length = env->GetArrayLength(rowArray);
+			if (y == 0) {
+				width = length;
+				row.resize(size_t(width));
+				costs.resize(size_t(width) * size_t(height));
+			} else if (length != width) {
+				env->DeleteLocalRef(rowArray);
+				return raise(env, "java/lang/IllegalArgumentException", "Irregular cost matrix");
+			}
+
+			env->GetDoubleArrayRegion(rowArray, 0, width, row.data());
+			env->DeleteLocalRef(rowArray);
+
+			int64_t * const costRow = costs.data() + size_t(y) * size_t(width);
+			for (jsize x = 0; x < width; ++x) {
+				const double value = row[size_t(x)];
+				if (!(std::fabs(value) <= 9007199254740992.0) || value != std::trunc(value))
+					return raise(env, "java/lang/IllegalArgumentException", "Costs must be whole numbers of at most 2^53");
+				costRow[x] = int64_t(value);
+			}
+		}
+
+		columns.assign(size_t(height), -1);
+	} catch (const std::bad_alloc &) {
+		return raise(env, "java/lang/OutOfMemoryError", "APSO");
+	}
+
+	// An empty matrix has nothing to assign.
+	const apso_status status = width && height
+		? apso_solve(costs.data(), size_t(width), size_t(height), size_t(width), APSO_I64, columns.data(), nullptr)
+		: APSO_OK;
+	if (status == APSO_NO_MEMORY) return raise(env, "java/lang/OutOfMemoryError", "APSO");
+	if (status != APSO_OK) return raise(env, "java/lang/IllegalArgumentException", "The matrix could not be solved");
+
+	const jintArray result = env->NewIntArray(height);
+	if (result) env->SetIntArrayRegion(result, 0, height, reinterpret_cast<const jint *>(columns.data()));
+	return result;
+}
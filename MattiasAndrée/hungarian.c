@@ -20,21 +20,6 @@
 
 
 
-/**
- * Cell markings
- **/
-enum {
-	UNMARKED = 0,
-	MARKED,
-	PRIME
-};
-
-
-/**
- *  Value type for marking
- */
-typedef int_fast8_t Mark;
-
 /**
  *  Value type for cells
  */
@@ -79,6 +64,54 @@ typedef struct {
 } CellPosition;
 
 
+/**
+ * The memory used while calculating a matching,
+ * carved out of a single block of memory
+ */
+typedef struct {
+	/**
+	 * The set of uncovered zeroes in the table
+	 */
+	BitSet *zeroes;
+
+	/**
+	 * The column of the marking in each row, -1 if none
+	 */
+	ssize_t *row_star;
+
+	/**
+	 * The row of the marking in each column, -1 if none
+	 */
+	ssize_t *col_star;
+
+	/**
+	 * The column of the prime in each row, -1 if none
+	 */
+	ssize_t *row_prime;
+
+	/**
+	 * Row pointers into a contiguous table
+	 */
+	Cell **rows;
+
+	/**
+	 * Row cover array
+	 */
+	Boolean *row_covered;
+
+	/**
+	 * Column cover array
+	 */
+	Boolean *col_covered;
+} Workspace;
+
+
+/**
+ * Rounds a size up so that the next part of a workspace is aligned
+ */
+#define KUHN_ALIGN(size)  (((size) + 15) & ~(size_t)15)
+
+
 
 /**
  * Calculates the floored binary logarithm of a positive integer
@@ -107,20 +140,38 @@ lb(BitSetLimb value)
 
 
 /**
- * Constructor for BitSet
+ * Calculates the amount of memory a BitSet needs
+ *
+ * @param   size  The (fixed) number of bits to bit set should contain
+ * @return        The number of bytes needed for the BitSet
+ */
+#if defined(__GNUC__)
+__attribute__((__const__))
+#endif
+static size_t
+bitset_size(size_t size)
+{
+	size_t c = (size >> 6) + !!(size & 63L);
+	return offsetof(BitSet, _buf) + c * sizeof(BitSetLimb) + 2 * (c + 1) * sizeof(size_t);
+}
+
+
+/**
+ * Constructor for BitSet, in memory provided by the caller
  *
+ * @param   buf   Memory of at least `bitset_size(size)` bytes
  * @param   size  The (fixed) number of bits to bit set should contain
  * @return        The a unique BitSet instance with the specified size
  */
 static BitSet *
-bitset_create(size_t size)
+bitset_init(void *buf, size_t size)
 {
 	size_t c     = (size >> 6) + !!(size & 63L);
-	BitSet *this = calloc(1, offsetof(BitSet, _buf) + c * sizeof(BitSetLimb) + 2 * (c + 1) * sizeof(size_t));
+	BitSet *this = memset(buf, 0, bitset_size(size));
 
 	this->limbs =  (BitSetLimb *)&this->_buf[0];
 	this->prev  = (size_t *)&this->_buf[c * sizeof(BitSetLimb)];
-	this->next  = (size_t *)&this->_buf[c * sizeof(BitSetLimb) + c * sizeof(size_t)];
+	this->next  = (size_t *)&this->_buf[c * sizeof(BitSetLimb) + (c + 1) * sizeof(size_t)];
 
 	return this;
 }
@@ -225,76 +276,128 @@ kuhn_reduce_rows(size_t n, size_t m, Cell **t)
 }
 
 
+/**
+ * Adds all zeroes in the table to a set of zeroes,
+ * as if no row or column was covered
+ *
+ * @param  n       The table's height
+ * @param  m       The table's width
+ * @param  t       The table
+ * @param  zeroes  The set of uncovered zeroes
+ */
+static void
+kuhn_collect_zeroes(size_t n, size_t m, Cell **t, BitSet *zeroes)
+{
+	size_t i, j;
+
+	for (i = 0; i < n; i++)
+		for (j = 0; j < m; j++)
+			if (!t[i][j])
+				bitset_set(zeroes, i * m + j);
+}
+
+
+/**
+ * Uncovers all rows, and adds their zeroes that are
+ * in uncovered columns to the set of uncovered zeroes
+ *
+ * @param  n            The table's height
+ * @param  m            The table's width
+ * @param  t            The table
+ * @param  row_covered  Row cover array
+ * @param  col_covered  Column cover array
+ * @param  zeroes       The set of uncovered zeroes
+ */
+static void
+kuhn_uncover_rows(size_t n, size_t m, Cell **t, Boolean row_covered[n], Boolean col_covered[m], BitSet *zeroes)
+{
+	size_t i, j;
+
+	for (i = 0; i < n; i++) {
+		if (!row_covered[i])
+			continue;
+		row_covered[i] = 0;
+		for (j = 0; j < m; j++)
+			if (!col_covered[j] && !t[i][j])
+				bitset_set(zeroes, i * m + j);
+	}
+}
+
+
 /**
  * Determines whether the marking is complete, that is
  * if each row has a marking which is on a unique column.
+ * Columns with a marking are covered, and columns without
+ * one are uncovered, while at it.
  *
  * @param   n            The table's height
  * @param   m            The table's width
- * @param   marks        The marking matrix
+ * @param   t            The table
+ * @param   col_star     The row of the marking in each column
+ * @param   row_covered  Row cover array
  * @param   col_covered  Column cover array
+ * @param   zeroes       The set of uncovered zeroes
  * @return               Whether the marking is complete
  */
 static Boolean
-kuhn_is_done(size_t n, size_t m, Mark **marks, Boolean col_covered[m])
+kuhn_is_done(size_t n, size_t m, Cell **t, ssize_t col_star[m], Boolean row_covered[n], Boolean col_covered[m], BitSet *zeroes)
 {
 	size_t i, j, count = 0;
-
-	memset(col_covered, 0, m * sizeof(*col_covered));
+	Boolean covered;
 
 	for (j = 0; j < m; j++) {
-		for (i = 0; i < n; i++) {
-			if (marks[i][j] == MARKED) {
-				col_covered[j] = 1;
-				break;
+		covered = col_star[j] >= 0;
+
+		if (covered != col_covered[j]) {
+			col_covered[j] = covered;
+			for (i = 0; i < n; i++) {
+				if (!t[i][j] && !row_covered[i]) {
+					if (covered)
+						bitset_unset(zeroes, i * m + j);
+					else
+						bitset_set(zeroes, i * m + j);
+				}
 			}
 		}
-	}
 
-	for (j = 0; j < m; j++)
-		count += (size_t)col_covered[j];
+		count += (size_t)covered;
+	}
 
 	return count == n;
 }
 
 
 /**
- * Create a matrix with marking of cells in the table whose
- * value is zero [minimal for the row]. Each marking will
- * be on an unique row and an unique column.
+ * Marks cells in the table whose value is zero [minimal
+ * for the row]. Each marking will be on an unique row
+ * and an unique column.
  * 
- * @param   n  The table's height
- * @param   m  The table's width
- * @param   t  The table in which to perform the reduction
- * @return     A matrix of markings as described in the summary
+ * @param  n         The table's height
+ * @param  m         The table's width
+ * @param  t         The table in which to perform the reduction
+ * @param  row_star  Output array for the column of the marking in each row
+ * @param  col_star  Output array for the row of the marking in each column
  */
-static Mark **
-kuhn_mark(size_t n, size_t m, Cell **t)
+static void
+kuhn_mark(size_t n, size_t m, Cell **t, ssize_t row_star[n], ssize_t col_star[m])
 {
 	size_t i, j;
-	Mark **marks;
-	Boolean *row_covered, *col_covered;
 
-	marks = malloc(n * sizeof(Mark *));
 	for (i = 0; i < n; i++)
-		marks[i] = calloc(m, sizeof(Mark)); /* UNMARKED == 0 */
+		row_star[i] = -1;
 
-	row_covered = calloc(n, sizeof(Boolean));
-	col_covered = calloc(m, sizeof(Boolean));
+	for (j = 0; j < m; j++)
+		col_star[j] = -1;
 
 	for (i = 0; i < n; i++) {
 		for (j = 0; j < m; j++) {
-			if (!row_covered[i] && !col_covered[j] && !t[i][j]) {
-				marks[i][j] = MARKED;
-				row_covered[i] = 1;
-				col_covered[j] = 1;
+			if (col_star[j] < 0 && !t[i][j]) {
+				row_star[i] = (ssize_t)j;
+				col_star[j] = (ssize_t)i;
+				break;
 			}
 		}
 	}
-
-	free(row_covered);
-	free(col_covered);
-	return marks;
 }
 
 
@@ -304,47 +407,33 @@ kuhn_mark(size_t n, size_t m, Cell **t)
  * @param   n            The table's height
  * @param   m            The table's width
  * @param   t            The table
- * @param   marks        The marking matrix
+ * @param   row_star     The column of the marking in each row
+ * @param   row_prime    The column of the prime in each row
  * @param   row_covered  Row cover array
  * @param   col_covered  Column cover array
+ * @param   zeroes       The set of uncovered zeroes, kept up to date with the covers
  * @param   primep       Output parameter for the row and column of the found prime
  * @return               1 if a prime was found, 0 otherwise
  */
 static Boolean
-kuhn_find_prime(size_t n, size_t m, Cell **t, Mark **marks, Boolean row_covered[n], Boolean col_covered[m], CellPosition *primep)
+kuhn_find_prime(size_t n, size_t m, Cell **t, ssize_t row_star[n], ssize_t row_prime[n],
+                Boolean row_covered[n], Boolean col_covered[m], BitSet *zeroes, CellPosition *primep)
 {
 	size_t i, j, row, col;
 	ssize_t p;
-	Boolean mark_in_row;
-	BitSet *zeroes = bitset_create(n * m);
-
-	for (i = 0; i < n; i++)
-		if (!row_covered[i])
-			for (j = 0; j < m; j++)
-				if (!col_covered[j] && !t[i][j])
-					bitset_set(zeroes, i * m + j);
 
 	for (;;) {
 		p = bitset_any(zeroes);
-		if (p < 0) {
-			free(zeroes);
+		if (p < 0)
 			return 0;
-		}
 
 		row = (size_t)p / m;
 		col = (size_t)p % m;
 	
-		marks[row][col] = PRIME;
-	
-		mark_in_row = 0;
-		for (j = 0; j < m; j++) {
-			if (marks[row][j] == MARKED) {
-				mark_in_row = 1;
-				col = j;
-			}
-		}
+		row_prime[row] = (ssize_t)col;
 
-		if (mark_in_row) {
+		if (row_star[row] >= 0) {
+			col = (size_t)row_star[row];
 			row_covered[row] = 1;
 			col_covered[col] = 0;
 
@@ -371,7 +460,6 @@ kuhn_find_prime(size_t n, size_t m, Cell **t, Mark **marks, Boolean row_covered[
 			else
 				bitset_unset(zeroes, row * m + col);
 		} else {
-			free(zeroes);
 			primep->row = row;
 			primep->col = col;
 			return 1;
@@ -382,79 +470,55 @@ kuhn_find_prime(size_t n, size_t m, Cell **t, Mark **marks, Boolean row_covered[
 
 /**
  * Removes all prime marks and modifies the marking
+ * along the path starting at the last found prime
  *
- * @param  n           The table's height
- * @param  m           The table's width
- * @param  marks       The marking matrix
- * @param  alt         Marking modification paths
- * @param  col_marks   Markings in the columns
- * @param  row_primes  Primes in the rows
- * @param  prime       The last found prime
+ * @param  n          The table's height
+ * @param  m          The table's width
+ * @param  row_star   The column of the marking in each row
+ * @param  col_star   The row of the marking in each column
+ * @param  row_prime  The column of the prime in each row
+ * @param  prime      The last found prime
  */
 static void
-kuhn_alt_marks(size_t n, size_t m, Mark **marks, CellPosition alt[n * m],
-               ssize_t col_marks[m], ssize_t row_primes[n], const CellPosition *prime)
+kuhn_alt_marks(size_t n, size_t m, ssize_t row_star[n], ssize_t col_star[m],
+               ssize_t row_prime[n], const CellPosition *prime)
 {
-	size_t i, j, index = 0;
-	ssize_t row, col;
-	Mark *markx, *marksi;
-
-	alt[0].row = prime->row;
-	alt[0].col = prime->col;
-
-	for (i = 0; i < n; i++)
-		row_primes[i] = -1;
-
-	for (i = 0; i < m; i++)
-		col_marks[i] = -1;
-
-	for (i = 0; i < n; i++) {
-		for (j = 0; j < m; j++) {
-			if (marks[i][j] == MARKED)
-				col_marks[j] = (ssize_t)i;
-			else if (marks[i][j] == PRIME)
-				row_primes[i] = (ssize_t)j;
-		}
-	}
-
-	while ((row = col_marks[alt[index].col]) >= 0) {
-		index++;
-		alt[index].row = (size_t)row;
-		alt[index].col = alt[index - 1].col;
-
-		col = row_primes[alt[index].row];
-		index++;
-		alt[index].row = alt[index - 1].row;
-		alt[index].col = (size_t)col;
-	}
+	size_t i;
+	ssize_t row = (ssize_t)prime->row, col = (ssize_t)prime->col, next;
 
-	for (i = 0; i <= index; i++) {
-		markx = &marks[alt[i].row][alt[i].col];
-		*markx = *markx == MARKED ? UNMARKED : MARKED;
+	/* Mark each prime on the path, which unmarks
+	 * the marking in its column. The row of that
+	 * marking continues the path with its prime. */
+	for (;;) {
+		next = col_star[col];
+		row_star[row] = col;
+		col_star[col] = row;
+		if (next < 0)
+			break;
+		row = next;
+		col = row_prime[row];
 	}
 
-	for (i = 0; i < n; i++) {
-		marksi = marks[i];
-		for (j = 0; j < m; j++)
-			if (marksi[j] == PRIME)
-				marksi[j] = UNMARKED;
-	}
+	for (i = 0; i < n; i++)
+		row_prime[i] = -1;
 }
 
 
 /**
  * Depending on whether the cells' rows and columns are covered,
  * the the minimum value in the table is added, subtracted or
- * neither from the cells.
+ * neither from the cells. Cells that become uncovered zeroes
+ * are added to the set of uncovered zeroes.
  *
  * @param  n            The table's height
  * @param  m            The table's width
  * @param  t            The table to manipulate
  * @param  row_covered  Array that tell whether the rows are covered
  * @param  col_covered  Array that tell whether the columns are covered
+ * @param  zeroes       The set of uncovered zeroes
  */
 static void
-kuhn_add_and_subtract(size_t n, size_t m, Cell **t, Boolean row_covered[n], Boolean col_covered[m])
+kuhn_add_and_subtract(size_t n, size_t m, Cell **t, Boolean row_covered[n], Boolean col_covered[m], BitSet *zeroes)
 {
 	size_t i, j;
 	Cell min = 0x7FFFFFFFL;
@@ -473,33 +537,127 @@ kuhn_add_and_subtract(size_t n, size_t m, Cell **t, Boolean row_covered[n], Bool
 				t[i][j] -= min;
 		}
 	}
+
+	for (i = 0; i < n; i++)
+		if (!row_covered[i])
+			for (j = 0; j < m; j++)
+				if (!col_covered[j] && !t[i][j])
+					bitset_set(zeroes, i * m + j);
 }
 
 
 /**
  * Creates a list of the assignment cells
  * 
- * @param   n      The table's height
- * @param   m      The table's width
- * @param   marks  Matrix markings
- * @return         The assignment, an array of row–coloumn pairs
+ * @param  n           The table's height
+ * @param  row_star    The column of the marking in each row
+ * @param  assignment  Output array of row–coloumn pairs
  */
-static CellPosition *
-kuhn_assign(size_t n, size_t m, Mark **marks)
+static void
+kuhn_assign(size_t n, ssize_t row_star[n], CellPosition assignment[n])
 {
-	CellPosition *assignment = malloc(n * sizeof(CellPosition));
-	size_t i, j;
+	size_t i;
 
 	for (i = 0; i < n; i++) {
-		for (j = 0; j < m; j++) {
-			if (marks[i][j] == MARKED) {
-				assignment[i].row = i;
-				assignment[i].col = j;
-			}
-		}
+		assignment[i].row = i;
+		assignment[i].col = (size_t)row_star[i];
 	}
+}
 
-	return assignment;
+
+/**
+ * Calculates the number of bytes of workspace needed to
+ * calculate a matching for a table of the given size
+ * 
+ * @param   n  The height of the table
+ * @param   m  The width of the table
+ * @return     The size of the workspace for `kuhn_match_strided`
+ */
+#if defined(__GNUC__)
+__attribute__((__const__))
+#endif
+static size_t
+kuhn_workspace_size(size_t n, size_t m)
+{
+	return KUHN_ALIGN(bitset_size(n * m))
+	     + KUHN_ALIGN(n * sizeof(ssize_t))
+	     + KUHN_ALIGN(m * sizeof(ssize_t))
+	     + KUHN_ALIGN(n * sizeof(ssize_t))
+	     + KUHN_ALIGN(n * sizeof(Cell *))
+	     + KUHN_ALIGN(n * sizeof(Boolean))
+	     + KUHN_ALIGN(m * sizeof(Boolean));
+}
+
+
+/**
+ * Splits a block of memory into the parts of a workspace,
+ * and clears the parts that have to start out cleared
+ * 
+ * @param  n          The height of the table
+ * @param  m          The width of the table
+ * @param  memory     At least `kuhn_workspace_size(n, m)` bytes, aligned to 16 bytes
+ * @param  workspace  Output parameter for the workspace
+ */
+static void
+kuhn_workspace_init(size_t n, size_t m, void *memory, Workspace *workspace)
+{
+	char *p = memory;
+	size_t i;
+
+	workspace->zeroes = bitset_init(p, n * m);
+	p += KUHN_ALIGN(bitset_size(n * m));
+
+	workspace->row_star = (ssize_t *)p;
+	p += KUHN_ALIGN(n * sizeof(ssize_t));
+
+	workspace->col_star = (ssize_t *)p;
+	p += KUHN_ALIGN(m * sizeof(ssize_t));
+
+	workspace->row_prime = (ssize_t *)p;
+	for (i = 0; i < n; i++)
+		workspace->row_prime[i] = -1;
+	p += KUHN_ALIGN(n * sizeof(ssize_t));
+
+	workspace->rows = (Cell **)p;
+	p += KUHN_ALIGN(n * sizeof(Cell *));
+
+	workspace->row_covered = memset(p, 0, n * sizeof(Boolean));
+	p += KUHN_ALIGN(n * sizeof(Boolean));
+
+	workspace->col_covered = memset(p, 0, m * sizeof(Boolean));
+}
+
+
+/**
+ * Calculates an optimal bipartite minimum weight matching
+ * using memory from an initialised workspace
+ * 
+ * @param  n           The height of the table
+ * @param  m           The width of the table
+ * @param  table       The table in which to perform the matching
+ * @param  w           The workspace
+ * @param  assignment  Output array of row–coloumn pairs
+ */
+static void
+kuhn_solve(size_t n, size_t m, Cell **table, Workspace *w, CellPosition assignment[n])
+{
+	CellPosition prime;
+
+	kuhn_reduce_rows(n, m, table);
+	kuhn_mark(n, m, table, w->row_star, w->col_star);
+
+	/* The uncovered zeroes are only collected once, and are
+	 * then kept up to date as the table and covers change. */
+	kuhn_collect_zeroes(n, m, table, w->zeroes);
+
+	while (!kuhn_is_done(n, m, table, w->col_star, w->row_covered, w->col_covered, w->zeroes)) {
+		while (!kuhn_find_prime(n, m, table, w->row_star, w->row_prime, w->row_covered, w->col_covered, w->zeroes, &prime))
+			kuhn_add_and_subtract(n, m, table, w->row_covered, w->col_covered, w->zeroes);
+		kuhn_alt_marks(n, m, w->row_star, w->col_star, w->row_prime, &prime);
+		kuhn_uncover_rows(n, m, table, w->row_covered, w->col_covered, w->zeroes);
+	}
+
+	kuhn_assign(n, w->row_star, assignment);
 }
 
 
@@ -516,50 +674,46 @@ kuhn_assign(size_t n, size_t m, Mark **marks)
 static CellPosition *
 kuhn_match(size_t n, size_t m, Cell **table)
 {
-	size_t i;
-	ssize_t *row_primes, *col_marks;
-	Mark **marks;
-	Boolean *row_covered, *col_covered;
-	CellPosition *ret, prime, *alt;
+	CellPosition *ret = malloc(n * sizeof(CellPosition));
+	void *memory = malloc(kuhn_workspace_size(n, m));
+	Workspace workspace;
 
 	/* Not copying table since it will only be used once. */
 
-	row_covered = calloc(n, sizeof(Boolean));
-	col_covered = calloc(m, sizeof(Boolean));
-
-	row_primes = malloc(n * sizeof(ssize_t));
-	col_marks  = malloc(m * sizeof(ssize_t));
+	kuhn_workspace_init(n, m, memory, &workspace);
+	kuhn_solve(n, m, table, &workspace, ret);
 
-	alt = malloc(n * m * sizeof(CellPosition));
-
-	kuhn_reduce_rows(n, m, table);
-	marks = kuhn_mark(n, m, table);
-
-	while (!kuhn_is_done(n, m, marks, col_covered)) {
-		while (!kuhn_find_prime(n, m, table, marks, row_covered, col_covered, &prime))
-			kuhn_add_and_subtract(n, m, table, row_covered, col_covered);
-		kuhn_alt_marks(n, m, marks, alt, col_marks, row_primes, &prime);
-		memset(row_covered, 0, n * sizeof(*row_covered));
-		memset(col_covered, 0, m * sizeof(*col_covered));
-	}
+	free(memory);
+	return ret;
+}
 
-	free(row_covered);
-	free(col_covered);
-	free(alt);
-	free(row_primes);
-	free(col_marks);
 
-	ret = kuhn_assign(n, m, marks);
+/**
+ * Calculates an optimal bipartite minimum weight matching, like
+ * `kuhn_match`, for a table stored in a single block of memory,
+ * without allocating any memory.
+ * 
+ * @param  n           The height of the table
+ * @param  m           The width of the table
+ * @param  table       The table, where row `i` starts at `table + i * stride`
+ * @param  stride      The distance between the starts of two rows, in cells
+ * @param  workspace   At least `kuhn_workspace_size(n, m)` bytes, aligned to 16 bytes,
+ *                     which can be reused for any number of matchings
+ * @param  assignment  Output array of row–coloumn pairs
+ */
+static void
+kuhn_match_strided(size_t n, size_t m, Cell *table, size_t stride, void *workspace, CellPosition assignment[n])
+{
+	Workspace w;
+	size_t i;
 
+	kuhn_workspace_init(n, m, workspace, &w);
 	for (i = 0; i < n; i++)
-		free(marks[i]);
-	free(marks);
+		w.rows[i] = table + i * stride;
 
-	return ret;
+	kuhn_solve(n, m, w.rows, &w, assignment);
 }
 
-
-
 static void
 print(size_t n, size_t m, Cell **t, CellPosition assignment[n])
 {
@@ -1,3 +1,5 @@
+#include "../Benchmark/timing.h"
+#include "../Benchmark/generators.h"
 #include <time.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -41,29 +43,37 @@ void specificTests(void) {
 void speedTest(size_t count, size_t size) {
 	printf("==Speed Test (%lu %lux%lu)==\n", count, size, size);
 
-	// allocate matrix
-	Cell** t = malloc(size * sizeof(Cell*));
-	for (size_t i = 0; i < size; ++i)
-		t[i] = malloc(size * sizeof(Cell));
+	// allocate matrix, workspace, assignment, and times once
+	Cell* t = malloc(size * size * sizeof(Cell));
+	void* workspace = malloc(kuhn_workspace_size(size, size));
+	CellPosition* assignment = malloc(size * sizeof(CellPosition));
+	double* times = malloc(count * sizeof(double));
 
 	const size_t THOUSAND = 1000;
 	const size_t MILLION = THOUSAND * THOUSAND;
 	const size_t BILLION = MILLION * THOUSAND;
 	const Cell max_size = size * size;
-	clock_t totalTime = 0;
+	const size_t warmup = TIMING_WARMUP(count);
 
-	for (size_t total = 1; total <= count; ++total) {
+	// the first `warmup` matrices are solved without being timed
+	for (size_t run = 0; run < warmup + count; ++run) {
 		// fill with random values
 		for (size_t i = 0; i < size; ++i) {
 			for (size_t j = 0; j < size; ++j) {
 				int num;
 				do { num = rand();
 				} while (num > (RAND_MAX - ((RAND_MAX % max_size) + 1) % max_size));
-				t[i][j] = (Cell)num % max_size;
+				t[i * size + j] = (Cell)num % max_size;
 			}
 		}
 
+		if (run < warmup) {
+			kuhn_match_strided(size, size, t, size, workspace, assignment);
+			continue;
+		}
+
 		// print iteration count
+		const size_t total = run - warmup + 1;
 		if (total < 12) printf("\n%lu", total);
 		else if (total < 100 && total % 12 == 0) printf("\n%lu Dozen", total / 12);
 		else if (total < THOUSAND && total % 100 == 0) printf("\n%lu Hundred", total / 100);
@@ -71,20 +81,63 @@ void speedTest(size_t count, size_t size) {
 		else if (total < BILLION && total % MILLION == 0) printf("\n%lu Million", total / MILLION);
 		else if (total % BILLION == 0) printf("\n%lu Billion", total / BILLION);
 
-		clock_t start = clock();
-		kuhn_match(size, size, t);
-		clock_t end = clock();
-		totalTime += end - start;
+		uint64_t start = timing_now();
+		kuhn_match_strided(size, size, t, size, workspace, assignment);
+		times[total - 1] = timing_seconds(start, timing_now());
 	}
 
-	printf("\n\n%fs Average Time\n\n", ((double)totalTime / (double)count) / CLOCKS_PER_SEC);
+	TimingSummary summary = timing_summarize(times, count);
+	printf("\n\n");
+	timing_print(stdout, &summary);
+	printf("\n");
 
-	// free matrix
-	for (size_t i = 0; i < size; ++i) free(t[i]);
+	// free matrix, workspace, assignment, and times
 	free(t);
+	free(workspace);
+	free(assignment);
+	free(times);
 }
 
 
+// solves `count` matrices of each family in generators.h and summarizes the times
+void familyTest(size_t count, size_t size) {
+	printf("==Family Test (%lu %lux%lu)==\n\n", count, size, size);
+
+	// allocate costs, matrix, workspace, assignment, and times once
+	unsigned long* costs = malloc(size * size * sizeof(unsigned long));
+	Cell* t = malloc(size * size * sizeof(Cell));
+	void* workspace = malloc(kuhn_workspace_size(size, size));
+	CellPosition* assignment = malloc(size * sizeof(CellPosition));
+	double* times = malloc(count * sizeof(double));
+
+	const uint64_t seed = (uint64_t)time(NULL);
+	const size_t warmup = TIMING_WARMUP(count);
+
+	for (int family = 0; family < GENERATOR_FAMILIES; ++family) {
+		for (size_t run = 0; run < warmup + count; ++run) {
+			generator_fill((GeneratorFamily)family, generator_mix(generator_mix(seed, family), run), size, size, costs);
+			for (size_t i = 0; i < size * size; ++i)
+				t[i] = (Cell)costs[i];
+
+			uint64_t start = timing_now();
+			kuhn_match_strided(size, size, t, size, workspace, assignment);
+			if (run >= warmup) times[run - warmup] = timing_seconds(start, timing_now());
+		}
+
+		TimingSummary summary = timing_summarize(times, count);
+		printf("%s:\n", generator_name((GeneratorFamily)family));
+		timing_print(stdout, &summary);
+	}
+	printf("\n");
+
+	// free costs, matrix, workspace, assignment, and times
+	free(costs);
+	free(t);
+	free(workspace);
+	free(assignment);
+	free(times);
+}
+
 int main(void) {
 	srand((unsigned)time(NULL));
 
@@ -92,6 +145,8 @@ int main(void) {
 	speedTest(10000,50);
 	speedTest(100,250);
 	speedTest(10,1000);
+	familyTest(1000,50);
+	familyTest(10,250);
 
 	return 0;
 }
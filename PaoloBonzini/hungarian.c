@@ -0,0 +1,629 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+
+#define cell	  size_t
+#define CELL_MAX  ULONG_MAX
+#define CELL_STR  "%lu"
+
+typedef uintptr_t llong;
+typedef unsigned char boolean;
+enum { FALSE, TRUE };
+
+
+/**
+ * Cell markings
+ */
+enum { UNMARKED, MARKED, PRIME };
+
+
+/**
+ * Bit set, a set of fixed number of bits/booleans
+ */
+typedef struct
+{
+	/**
+	 * The set of all limbs, a limb consist of 64 bits
+	 */
+	llong* limbs;
+
+	/**
+	 * Index of the first non-zero limb
+	 */
+	ssize_t first;
+
+	/**
+	 * Array the the index of the previous non-zero limb for each limb
+	 */
+	ssize_t* prev;
+
+	/**
+	 * Array the the index of the next non-zero limb for each limb
+	 */
+	ssize_t* next;
+
+} BitSet;
+
+
+
+ssize_t** kuhn_match(cell** table, size_t n, size_t m);
+size_t kuhn_workspaceSize(size_t n, size_t m);
+void kuhn_matchStrided(cell* table, size_t stride, size_t n, size_t m, void* workspace, ssize_t* assignment);
+
+static size_t BitSet_size(size_t size) __attribute__((const));
+static void BitSet_init(BitSet *this, size_t size, void* buffer);
+static void BitSet_clear(BitSet *this, size_t size);
+static void BitSet_set(BitSet *this, size_t i);
+static void BitSet_unset(BitSet *this, size_t i);
+static ssize_t BitSet_any(BitSet *this) __attribute__((pure));
+
+static size_t lb(llong x) __attribute__((const));
+
+/* @param   table  The table in which to perform the reduction
+ * @param   marks	   The marking matrix
+ * @param   colCovered  An array which tells whether a column is covered
+ * @param   rowCovered  An array which tells whether a row is covered
+ * @param  colMarks   Markings in the columns
+ * @param  rowPrimes  Primes in the rows
+ * @param  zeroes     The uncovered zeroes, used by kuhn_findPrime
+ * @param   n  The table's height
+ * @param   m  The table's width
+ */
+struct kuhn_data {
+	size_t n, m;
+	cell** table;
+	uint8_t** marks;
+	ssize_t* rowPrimes;
+	ssize_t* colMarks;
+	boolean* rowCovered;
+	boolean* colCovered;
+	BitSet zeroes;
+};
+
+/* Rounds a size up so that the next part of a workspace is aligned */
+#define KUHN_ALIGN(size)  (((size) + 15) & ~(size_t)15)
+
+static void kuhn_init(struct kuhn_data *k, size_t n, size_t m, void* workspace);
+static void kuhn_solve(struct kuhn_data *k);
+static void kuhn_reduceRows(struct kuhn_data *k);
+static size_t kuhn_markZeroes(struct kuhn_data *k);
+static size_t kuhn_countColumns(struct kuhn_data *k);
+static boolean kuhn_findPrime(struct kuhn_data *k, size_t* primeRow, size_t* primeCol);
+static void kuhn_altMarks(struct kuhn_data *k, ssize_t currRow, ssize_t currCol);
+static void kuhn_addAndSubtract(struct kuhn_data *k);
+static ssize_t** kuhn_assign(struct kuhn_data *k);
+
+/**
+ * Calculates an optimal bipartite minimum weight matching using an
+ * O(n³)-time implementation of The Hungarian Algorithm, also known
+ * as Kuhn's Algorithm.
+ *
+ * @param   table  The table in which to perform the matching
+ * @param   n	  The height of the table
+ * @param   m	  The width of the table
+ * @return		 The optimal assignment, an array of row–coloumn pairs
+ */
+ssize_t** kuhn_match(cell** table, size_t n, size_t m)
+{
+	struct kuhn_data k;
+	void* workspace = malloc(kuhn_workspaceSize(n, m));
+
+	/* not copying table since it will only be used once */
+	kuhn_init(&k, n, m, workspace);
+	k.table = table;
+
+	kuhn_solve(&k);
+	ssize_t** rc = kuhn_assign(&k);
+
+	free(workspace);
+	return rc;
+}
+
+
+/**
+ * Calculates the number of bytes of workspace kuhn_matchStrided
+ * needs for a table of the given size.
+ *
+ * @param   n	  The height of the table
+ * @param   m	  The width of the table
+ * @return		 The size of the workspace in bytes
+ */
+size_t kuhn_workspaceSize(size_t n, size_t m)
+{
+	return KUHN_ALIGN(BitSet_size(n * m))
+	     + KUHN_ALIGN(n * sizeof(ssize_t))
+	     + KUHN_ALIGN(m * sizeof(ssize_t))
+	     + KUHN_ALIGN(n * sizeof(cell*))
+	     + KUHN_ALIGN(n * sizeof(uint8_t*))
+	     + KUHN_ALIGN(n * m * sizeof(uint8_t))
+	     + KUHN_ALIGN(n * sizeof(boolean))
+	     + KUHN_ALIGN(m * sizeof(boolean));
+}
+
+
+/**
+ * Calculates an optimal bipartite minimum weight matching like
+ * kuhn_match, for a table stored in a single block of memory,
+ * without allocating any memory.
+ *
+ * @param   table	   The table, where row i starts at table + i * stride
+ * @param   stride	  The distance between the starts of two rows, in cells
+ * @param   n		   The height of the table
+ * @param   m		   The width of the table
+ * @param   workspace   At least kuhn_workspaceSize(n, m) bytes aligned to 16
+ *					  bytes, which can be reused for any number of matchings
+ * @param   assignment  Output array with the column assigned to each row
+ */
+void kuhn_matchStrided(cell* table, size_t stride, size_t n, size_t m, void* workspace, ssize_t* assignment)
+{
+	size_t i, j;
+	struct kuhn_data k;
+
+	kuhn_init(&k, n, m, workspace);
+	for (i = 0; i < n; i++)
+		k.table[i] = table + i * stride;
+
+	kuhn_solve(&k);
+
+	for (i = 0; i < n; i++)
+		for (j = 0; j < m; j++)
+		if (k.marks[i][j] == MARKED)
+			assignment[i] = (ssize_t)j;
+}
+
+
+/**
+ * Splits a workspace into the arrays used by the algorithm,
+ * and clears the ones that have to start out cleared.
+ *
+ * @param k The data to initialise
+ * @param n The height of the table
+ * @param m The width of the table
+ * @param workspace At least kuhn_workspaceSize(n, m) bytes aligned to 16 bytes
+ */
+void kuhn_init(struct kuhn_data *k, size_t n, size_t m, void* workspace)
+{
+	size_t i;
+	char* p = workspace;
+
+	k->n = n;
+	k->m = m;
+
+	BitSet_init(&k->zeroes, n * m, p);
+	p += KUHN_ALIGN(BitSet_size(n * m));
+
+	k->rowPrimes = (ssize_t*)p;
+	p += KUHN_ALIGN(n * sizeof(ssize_t));
+
+	k->colMarks = (ssize_t*)p;
+	p += KUHN_ALIGN(m * sizeof(ssize_t));
+
+	k->table = (cell**)p;
+	p += KUHN_ALIGN(n * sizeof(cell*));
+
+	k->marks = (uint8_t**)p;
+	p += KUHN_ALIGN(n * sizeof(uint8_t*));
+
+	memset(p, 0, n * m * sizeof(uint8_t));
+	for (i = 0; i < n; i++)
+		k->marks[i] = (uint8_t*)p + i * m;
+	p += KUHN_ALIGN(n * m * sizeof(uint8_t));
+
+	k->rowCovered = memset(p, 0, n * sizeof(boolean));
+	p += KUHN_ALIGN(n * sizeof(boolean));
+
+	k->colCovered = memset(p, 0, m * sizeof(boolean));
+}
+
+
+/**
+ * Runs the algorithm on initialised data.
+ *
+ * @param k The data from kuhn_match
+ */
+void kuhn_solve(struct kuhn_data *k)
+{
+	kuhn_reduceRows(k);
+	if (kuhn_markZeroes(k) < k->n) {
+		do {
+			size_t primeRow, primeCol;
+			while (!kuhn_findPrime(k, &primeRow, &primeCol))
+			kuhn_addAndSubtract(k);
+
+		kuhn_altMarks(k, primeRow, primeCol);
+		} while (kuhn_countColumns(k) < k->n);
+	}
+}
+
+
+/**
+ * Reduces the values on each rows so that, for each row, the
+ * lowest cells value is zero, and all cells' values is decrease
+ * with the same value [the minium value in the row].
+ *
+ * @param k The data from kuhn_match
+ */
+void kuhn_reduceRows(struct kuhn_data *k)
+{
+	size_t i, j;
+	cell min;
+	cell* ti;
+	for (i = 0; i < k->n; i++) {
+		ti = k->table[i];
+		min = ti[0];
+	for (j = 1; j < k->m; j++)
+		if (min > ti[j])
+			min = ti[j];
+	
+	for (j = 0; j < k->m; j++)
+		ti[j] -= min;
+	}
+}
+
+
+/**
+ * Fill a matrix with marking of cells in the table whose
+ * value is zero [minimal for the row]. Each marking will
+ * be on an unique row and an unique column.
+ *
+ * @param k The data from kuhn_match
+ * @return  The number of covered columns
+ */
+size_t kuhn_markZeroes(struct kuhn_data *k)
+{
+	size_t i, j;
+	size_t count = 0;
+
+	for (i = 0; i < k->n; i++)
+		for (j = 0; j < k->m; j++)
+		if (!k->colCovered[j] && k->table[i][j] == 0) {
+			k->marks[i][j] = MARKED;
+		k->colCovered[j] = TRUE;
+				count++;
+				break;
+		}
+
+	return count;
+}
+
+
+/**
+ * Determines whether the marking is complete, that is
+ * if each row has a marking which is on a unique column.
+ * Find covered columns while at it.
+ *
+ * @param k The data from kuhn_match
+ * @return			  Number of rows with a mark
+ */
+size_t kuhn_countColumns(struct kuhn_data *k)
+{
+	size_t i, j;
+	size_t count = 0;
+
+	memset(k->colCovered, 0, k->m);
+	for (i = 0; i < k->n; i++)
+		for (j = 0; j < k->m; j++)
+		if (!k->colCovered[j] && k->marks[i][j] == MARKED) {
+			k->colCovered[j] = TRUE;
+				count++;
+		break;
+		}
+
+	return count;
+}
+
+
+/**
+ * Finds a prime
+ *
+ * @param k The data from kuhn_match
+ * @param primeRow	The row of the found prime
+ * @param primeCol	The column of the found prime
+ * @return			  The row and column of the found print, <code>NULL</code> will be returned if none can be found
+ */
+boolean kuhn_findPrime(struct kuhn_data *k, size_t* primeRow, size_t* primeCol)
+{
+	size_t i, j;
+	size_t row, col;
+	BitSet* zeroes = &k->zeroes;
+
+	BitSet_clear(zeroes, k->n * k->m);
+
+	for (i = 0; i < k->n; i++)
+	for (j = 0; j < k->m; j++)
+		if (!k->colCovered[j] && k->table[i][j] == 0)
+		BitSet_set(zeroes, i * k->m + j);
+
+	memset(k->rowCovered, 0, k->n);
+	for (;;) {
+		ssize_t p = BitSet_any(zeroes);
+	if (p < 0)
+		return FALSE;
+	
+	row = (size_t)p / k->m;
+	col = (size_t)p % k->m;
+	
+	k->marks[row][col] = PRIME;
+	
+	for (j = 0; j < k->m; j++)
+		if (k->marks[row][j] == MARKED) {
+		col = j;
+				break;
+		}
+	
+	/* No other marks?  We're done.  */
+	if (j == k->m)
+			break;
+
+	BitSet_unset(zeroes, p);
+	k->rowCovered[row] = TRUE;
+	k->colCovered[col] = FALSE;
+	
+	/* Add zeroes to the bitmap for the now-uncovered column.  */
+	for (i = 0; i < k->n; i++)
+		if (row != i && k->table[i][col] == 0) {
+			if (!k->rowCovered[i])
+				BitSet_set(zeroes, i * k->m + col);
+			else
+				BitSet_unset(zeroes, i * k->m + col);
+		}
+	
+	/* Remove zeroes from the bitmap for the now-covered row.  */
+	for (j = 0; j < k->m; j++)
+		if (col != j && k->table[row][j] == 0)
+			BitSet_unset(zeroes, row * k->m + j);
+	
+	}
+
+	*primeRow = row;
+	*primeCol = col;
+	return TRUE;
+}
+
+
+static inline void kuhn_altMark(struct kuhn_data *k, ssize_t currRow, ssize_t currCol)
+{
+	if (k->marks[currRow][currCol] == MARKED)
+		k->marks[currRow][currCol] = UNMARKED;
+	else
+		k->marks[currRow][currCol] = MARKED;
+}
+
+/**
+ * Removes all prime marks and modifies the marking
+ *
+ * @param k The data from kuhn_match
+ * @param  currRow	The row of the last found prime
+ * @param  currCol	The column of the last found prime
+ */
+void kuhn_altMarks(struct kuhn_data *k, ssize_t currRow, ssize_t currCol)
+{
+	size_t i, j;
+
+	for (i = 0; i < k->n; i++)
+		k->rowPrimes[i] = -1;
+	for (j = 0; j < k->m; j++)
+		k->colMarks[j] = -1;
+
+	for (i = 0; i < k->n; i++)
+		for (j = 0; j < k->m; j++)
+		if (k->marks[i][j] == MARKED)
+			k->colMarks[j] = (ssize_t)i;
+		else if (k->marks[i][j] == PRIME)
+			k->rowPrimes[i] = (ssize_t)j;
+
+	kuhn_altMark(k, currRow, currCol);
+	for (;;) {
+		currRow = k->colMarks[currCol];
+	if (currRow < 0)
+		break;
+		kuhn_altMark(k, currRow, currCol);
+	
+	currCol = k->rowPrimes[currRow];
+		assert(currCol >= 0);
+		kuhn_altMark(k, currRow, currCol);
+	}
+
+	for (i = 0; i < k->n; i++) {
+		uint8_t *marksi = k->marks[i];
+		for (j = 0; j < k->m; j++)
+		if (marksi[j] == PRIME)
+			marksi[j] = UNMARKED;
+	}
+}
+
+
+/**
+ * Depending on whether the cells' rows and columns are covered,
+ * the the minimum value in the table is added, subtracted or
+ * neither from the cells.
+ *
+ * @param k The data from kuhn_match
+ */
+void kuhn_addAndSubtract(struct kuhn_data *k)
+{
+	size_t i, j;
+	cell min = CELL_MAX;
+	for (i = 0; i < k->n; i++)
+		if (!k->rowCovered[i])
+		for (j = 0; j < k->m; j++)
+			if (!k->colCovered[j] && min > k->table[i][j])
+			min = k->table[i][j];
+
+	for (i = 0; i < k->n; i++) {
+	if (k->rowCovered[i]) {
+			for (j = 0; j < k->m; j++) {
+			if (k->colCovered[j])
+				k->table[i][j] += min;
+			}
+	} else {
+			for (j = 0; j < k->m; j++) {
+			if (!k->colCovered[j])
+				k->table[i][j] -= min;
+			}
+		}
+	}
+}
+
+
+/**
+ * Creates a list of the assignment cells
+ *
+ * @param k The data from kuhn_match
+ * @return		 The assignment, an array of row–coloumn pairs
+ */
+ssize_t** kuhn_assign(struct kuhn_data *k)
+{
+	ssize_t** assignment = malloc(k->n * sizeof(ssize_t*));
+
+	size_t i, j;
+	for (i = 0; i < k->n; i++) {
+		assignment[i] = malloc(2 * sizeof(ssize_t));
+		for (j = 0; j < k->m; j++)
+		if (k->marks[i][j] == MARKED) {
+		assignment[i][0] = (ssize_t)i;
+		assignment[i][1] = (ssize_t)j;
+		}
+	}
+
+	return assignment;
+}
+
+
+/**
+ * Calculates the amount of memory a BitSet needs for its arrays
+ *
+ * @param   size  The (fixed) number of bits to bit set should contain
+ * @return		The number of bytes needed
+ */
+size_t BitSet_size(size_t size)
+{
+	size_t c = size >> 6L;
+	if (size & 63L)
+		c++;
+
+	return c * (sizeof(llong) + 2 * sizeof(ssize_t));
+}
+
+/**
+ * Constructor for BitSet, using memory provided by the caller
+ *
+ * @param   size    The (fixed) number of bits to bit set should contain
+ * @param   buffer  At least BitSet_size(size) bytes
+ */
+void BitSet_init(BitSet *this, size_t size, void* buffer)
+{
+	size_t c = size >> 6L;
+	if (size & 63L)
+		c++;
+
+	this->limbs = buffer;
+	this->prev = (ssize_t*)(this->limbs + c);
+	this->next = this->prev + c;
+	BitSet_clear(this, size);
+}
+
+/**
+ * Turns off all bits in a bit set
+ *
+ * @param   size  The (fixed) number of bits in the bit set
+ */
+void BitSet_clear(BitSet *this, size_t size)
+{
+	size_t c = size >> 6L;
+	if (size & 63L)
+		c++;
+
+	memset(this->limbs, 0, c * sizeof(llong));
+	this->first = -1;
+}
+
+/**
+ * Turns on a bit in a bit set
+ *
+ * @param  this  The bit set
+ * @param  i	 The index of the bit to turn on
+ */
+void BitSet_set(BitSet *this, size_t i)
+{
+	size_t j = i >> 6L;
+	llong old = this->limbs[j];
+
+	this->limbs[j] |= 1LL << (llong)(i & 63L);
+
+	if (!old) {
+		if (this->first != -1)
+		this->prev[this->first] = j;
+	this->prev[j] = -1;
+	this->next[j] = this->first;
+	this->first = j;
+	}
+}
+
+/**
+ * Turns off a bit in a bit set
+ *
+ * @param  this  The bit set
+ * @param  i	 The index of the bit to turn off
+ */
+void BitSet_unset(BitSet *this, size_t i)
+{
+	size_t j = i >> 6L;
+	llong old = this->limbs[j];
+
+	if (!old)
+		return;
+
+	this->limbs[j] &= ~(1LL << (llong)(i & 63L));
+
+	if (!this->limbs[j]) {
+	size_t p = this->prev[j];
+	size_t n = this->next[j];
+		if (n != -1)
+		this->prev[n] = p;
+		if (p == -1)
+		this->first = n;
+		else
+		this->next[p] = n;
+	}
+}
+
+/**
+ * Gets the index of any set bit in a bit set
+ *
+ * @param   this  The bit set
+ * @return		The index of any set bit
+ */
+ssize_t BitSet_any(BitSet *this)
+{
+	ssize_t i = this->first;
+	if (i == -1)
+		return -1;
+
+	return (ssize_t)(lb(this->limbs[i] & -this->limbs[i]) + (i << 6L));
+}
+
+
+/**
+ * Calculates the floored binary logarithm of a positive integer
+ *
+ * @param   value  The integer whose logarithm to calculate
+ * @return		 The floored binary logarithm of the integer
+ */
+size_t lb(llong value)
+{
+	size_t rc = 0;
+	llong v = value;
+
+	if (v & (int_fast64_t)0xFFFFFFFF00000000LL)  {  rc |= 32L;  v >>= 32LL;  }
+	if (v & (int_fast64_t)0x00000000FFFF0000LL)  {  rc |= 16L;  v >>= 16LL;  }
+	if (v & (int_fast64_t)0x000000000000FF00LL)  {  rc |=  8L;  v >>=  8LL;  }
+	if (v & (int_fast64_t)0x00000000000000F0LL)  {  rc |=  4L;  v >>=  4LL;  }
+	if (v & (int_fast64_t)0x000000000000000CLL)  {  rc |=  2L;  v >>=  2LL;  }
+	if (v & (int_fast64_t)0x0000000000000002LL)	 rc |=  1L;
+
+	return rc;
+}
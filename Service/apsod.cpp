@@ -0,0 +1,324 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <csignal>
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <type_traits>
+#include <sys/un.h>
+#include "../Yay295/APS.h"
+#include "protocol.h"
+
+
+// A service that solves cost matrices with the APSO for clients on the same
+// machine, so they do not have to start a process or link the solver for
+// every matrix. See protocol.h for what is sent over the socket.
+//
+// Usage: apsod [--socket PATH] [--threads N] [--batch N] [--pending N]
+//
+// Each connection has a thread that reads its requests and adds them to one
+// queue. The --threads worker threads (one per CPU by default) each take up to
+// --batch requests (16 by default) from the queue at a time, so that under
+// load a worker wakes up and takes the lock once per batch instead of once per
+// matrix. Each worker keeps its own buffers for the values it solves, so after
+// its first few requests, solving allocates only inside the APSO.
+//
+// The workers do not write to the sockets. They add each response to its
+// connection's own queue, and each connection has a thread that writes them,
+// so a client that does not read its responses only holds up itself. Once a
+// client has --pending requests (32 by default) that have not been answered,
+// its requests are not read until some are, so no client can make the service
+// hold more than that many of its matrices.
+// Stop the service with SIGINT or SIGTERM.
+
+
+// A client. It is closed once its reader is done and the last of its
+// requests has been answered.
+struct Connection {
+	const int fd;
+
+	std::mutex lock;
+	std::condition_variable changed;
+	std::deque<std::vector<char>> responses; // solved, but not yet written
+	std::vector<std::vector<char>> spare;    // written, to be reused
+	size_t unanswered = 0;                   // read, but not yet written
+	bool reading = true;
+
+	explicit Connection(const int newFd) : fd(newFd) {}
+	~Connection() { close(fd); }
+
+	// Adds a response to be written, and takes a spare buffer, if there is
+	// one, for the worker's next response.
+	void respond(std::vector<char> & response) {
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			responses.push_back(std::move(response));
+			response.clear();
+			if (!spare.empty()) {
+				response = std::move(spare.back());
+				spare.pop_back();
+			}
+		}
+		changed.notify_all();
+	}
+};
+
+struct Request {
+	std::shared_ptr<Connection> connection;
+	ServiceRequest header;
+	std::vector<char> costs;
+};
+
+
+class Queue {
+	std::mutex lock;
+	std::condition_variable ready;
+	std::deque<Request> requests;
+
+	public:
+
+	void push(Request && request) {
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			requests.push_back(std::move(request));
+		}
+		ready.notify_one();
+	}
+
+	// Waits for requests, and moves up to `most` of them into `batch`.
+	void take(std::vector<Request> & batch, const size_t most) {
+		std::unique_lock<std::mutex> guard(lock);
+		ready.wait(guard, [this]{ return !requests.empty(); });
+
+		const size_t count = std::min(most, requests.size());
+		batch.clear();
+		std::move(requests.begin(), requests.begin() + count, std::back_inserter(batch));
+		requests.erase(requests.begin(), requests.begin() + count);
+
+		// Leave the rest to another worker.
+		if (!requests.empty()) ready.notify_one();
+	}
+};
+
+
+// The buffers a worker reuses for every request it solves.
+struct Workspace {
+	std::vector<uint32_t> values32;
+	std::vector<uint64_t> values64;
+	std::vector<char> response;
+};
+
+template<typename U> std::vector<U> & valuesOf(Workspace & workspace);
+template<> std::vector<uint32_t> & valuesOf(Workspace & workspace) { return workspace.values32; }
+template<> std::vector<uint64_t> & valuesOf(Workspace & workspace) { return workspace.values64; }
+
+// Solves a request's matrix into the workspace's response.
+template<typename T>
+void solve(const Request & request, Workspace & workspace) {
+	// Costs of up to 32 bits are solved as 32 bit values, which the APSO is
+	// faster with, and the rest as 64 bit values.
+	typedef typename std::conditional<sizeof(T) <= 4, uint32_t, uint64_t>::type U;
+	std::vector<U> & values = valuesOf<U>(workspace);
+
+	// Flipping the sign bit of a signed cost, after widening it, maps it to
+	// an unsigned value in the same order, which is what the APSO needs.
+	constexpr U signBit = std::is_signed<T>::value ? U(U(1) << (sizeof(U) * 8 - 1)) : 0;
+
+	const size_t width = request.header.width, height = request.header.height;
+	const T * const costs = reinterpret_cast<const T *>(request.costs.data());
+
+	values.resize(width * height);
+	for (size_t i = 0; i < width * height; ++i)
+		values[i] = U(costs[i]) ^ signBit;
+
+	// This constructor solves `values` in place, so it is reused.
+	const APSO apso(values, width, height);
+
+	ServiceResponse response;
+	response.length = service_response_length(uint32_t(height));
+	response.id = request.header.id;
+	response.height = uint32_t(height);
+	response.reserved = 0;
+	response.total = 0;
+
+	workspace.response.resize(sizeof(response) + height * sizeof(uint32_t));
+	uint32_t * const columns = reinterpret_cast<uint32_t *>(&workspace.response[sizeof(response)]);
+	std::fill(columns, columns + height, BATCH_UNASSIGNED);
+	for (const auto & result : apso.results) {
+		columns[result.y] = uint32_t(result.x);
+		response.total += uint64_t(costs[result.y*width+result.x]);
+	}
+	std::memcpy(workspace.response.data(), &response, sizeof(response));
+}
+
+void solve(const Request & request, Workspace & workspace) {
+	switch (request.header.type) {
+		case BATCH_U8: solve<uint8_t>(request, workspace); break;
+		case BATCH_U16: solve<uint16_t>(request, workspace); break;
+		case BATCH_U32: solve<uint32_t>(request, workspace); break;
+		case BATCH_U64: solve<uint64_t>(request, workspace); break;
+		case BATCH_I8: solve<int8_t>(request, workspace); break;
+		case BATCH_I16: solve<int16_t>(request, workspace); break;
+		case BATCH_I32: solve<int32_t>(request, workspace); break;
+		case BATCH_I64: solve<int64_t>(request, workspace); break;
+	}
+}
+
+
+void work(Queue & queue, const size_t most) {
+	Workspace workspace;
+	std::vector<Request> batch;
+
+	for (;;) {
+		queue.take(batch, most);
+
+		for (const auto & request : batch) {
+			solve(request, workspace);
+			request.connection->respond(workspace.response);
+		}
+
+		// This releases the connections of the requests.
+		batch.clear();
+	}
+}
+
+// Writes a client's responses until its reader is done and every request it
+// read has been answered. If the client is gone, the rest are dropped.
+void writeResponses(std::shared_ptr<Connection> connection) {
+	bool connected = true;
+
+	std::unique_lock<std::mutex> guard(connection->lock);
+	for (;;) {
+		connection->changed.wait(guard, [&]{
+			return !connection->responses.empty() || (!connection->reading && !connection->unanswered);
+		});
+		if (connection->responses.empty()) break;
+
+		std::vector<char> response = std::move(connection->responses.front());
+		connection->responses.pop_front();
+
+		guard.unlock();
+		if (connected && !service_write(connection->fd, response.data(), response.size())) {
+			// Wake the reader too, if it is waiting for the client.
+			shutdown(connection->fd, SHUT_RDWR);
+			connected = false;
+		}
+		guard.lock();
+
+		connection->spare.push_back(std::move(response));
+		--connection->unanswered;
+		connection->changed.notify_all();
+	}
+}
+
+// Reads requests from a client until it disconnects or sends one that is not
+// valid, waiting while `pending` of them have not been answered.
+void readRequests(std::shared_ptr<Connection> connection, Queue & queue, const size_t pending) {
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> guard(connection->lock);
+			connection->changed.wait(guard, [&]{ return connection->unanswered < pending; });
+		}
+
+		Request request;
+		if (!service_read(connection->fd, &request.header, sizeof(request.header))) break;
+		if (!service_request_valid(&request.header)) {
+			std::cerr << "Closing a connection that sent a request that is not valid\n";
+			break;
+		}
+
+		request.costs.resize(request.header.length - (sizeof(request.header) - sizeof(uint32_t)));
+		if (!service_read(connection->fd, request.costs.data(), request.costs.size())) break;
+
+		request.connection = connection;
+		{
+			std::lock_guard<std::mutex> guard(connection->lock);
+			++connection->unanswered;
+		}
+		queue.push(std::move(request));
+	}
+
+	// Stop reading, but let the workers answer what was already read.
+	shutdown(connection->fd, SHUT_RD);
+	{
+		std::lock_guard<std::mutex> guard(connection->lock);
+		connection->reading = false;
+	}
+	connection->changed.notify_all();
+}
+
+
+const char * socketPath = SERVICE_SOCKET;
+
+void stop(int) {
+	unlink(socketPath);
+	_exit(0);
+}
+
+
+int usage() {
+	std::cerr << "Usage: apsod [--socket PATH] [--threads N] [--batch N] [--pending N]\n";
+	return 1;
+}
+
+int main(int argc, char ** argv) {
+	size_t threads = std::max(std::thread::hardware_concurrency(), 1u), most = 16, pending = 32;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+
+		if (arg == "--socket" && i + 1 < argc) {
+			socketPath = argv[++i];
+		} else if (arg == "--threads" && i + 1 < argc) {
+			threads = std::stoull(argv[++i]);
+			if (!threads) return usage();
+		} else if (arg == "--batch" && i + 1 < argc) {
+			most = std::stoull(argv[++i]);
+			if (!most) return usage();
+		} else if (arg == "--pending" && i + 1 < argc) {
+			pending = std::stoull(argv[++i]);
+			if (!pending) return usage();
+		} else return usage();
+	}
+
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if (std::strlen(socketPath) >= sizeof(address.sun_path)) {
+		std::cerr << "The socket path is too long\n";
+		return 1;
+	}
+	std::strcpy(address.sun_path, socketPath);
+
+	const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	unlink(socketPath);
+	if (listener < 0 || bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(listener, 128) != 0) {
+		std::perror(socketPath);
+		return 1;
+	}
+
+	std::signal(SIGINT, stop);
+	std::signal(SIGTERM, stop);
+
+	Queue queue;
+	for (size_t i = 0; i < threads; ++i)
+		std::thread(work, std::ref(queue), most).detach();
+
+	std::cerr << "Listening on " << socketPath << " with " << threads << " threads\n";
+
+	for (;;) {
+		const int client = accept(listener, nullptr, nullptr);
+		if (client < 0) {
+			if (errno != EINTR) std::perror("accept");
+			continue;
+		}
+		const auto connection = std::make_shared<Connection>(client);
+		std::thread(writeResponses, connection).detach();
+		std::thread(readRequests, connection, std::ref(queue), pending).detach();
+	}
+}
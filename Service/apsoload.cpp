@@ -0,0 +1,247 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <limits>
+#include <sys/un.h>
+#include "../Benchmark/timing.h"
+#include "../Benchmark/generators.h"
+#include "protocol.h"
+
+
+// Measures the throughput and latency of apsod.
+//
+// Usage: apsoload [--socket PATH] [--connections N] [--requests N] [--depth N]
+//                 [--size WIDTHxHEIGHT] [--family F] [--seed N]
+//
+// Each of the --connections connections (4 by default) sends --requests
+// requests (10000 by default) of u32 matrices of --size (50x50 by default)
+// from a family in generators.h, and keeps up to --depth of them (8 by
+// default) waiting for a response at a time. The matrices are made before the
+// test starts, so making them is not timed. The latency of a request is the
+// time from just before it is sent to when its response has been read. Every
+// response is checked to be a valid assignment whose total is right.
+//
+// Each connection sends on one thread and reads its responses on another, so
+// that it never stops reading while it waits to send.
+
+
+// The number of different matrices each connection sends.
+constexpr size_t MATRICES = 64;
+
+
+struct Options {
+	const char * socketPath = SERVICE_SOCKET;
+	size_t connections = 4, requests = 10000, depth = 8;
+	uint32_t width = 50, height = 50;
+	GeneratorFamily family = GENERATOR_UNIFORM;
+	unsigned long long seed = 1;
+};
+
+struct Results {
+	std::vector<double> latencies;
+	size_t wrong = 0;
+	bool failed = false;
+};
+
+
+// Returns whether a response is a valid assignment of the request's matrix,
+// with the right total.
+bool valid(const Options & options, const uint32_t * costs, const ServiceResponse & response, const std::vector<uint32_t> & columns) {
+	std::vector<char> used(options.width, false);
+	uint64_t total = 0;
+	size_t assigned = 0;
+
+	for (size_t row = 0; row < options.height; ++row) {
+		const uint32_t column = columns[row];
+		if (column == BATCH_UNASSIGNED) continue;
+		if (column >= options.width || used[column]) return false;
+
+		used[column] = true;
+		total += costs[row*options.width+column];
+		++assigned;
+	}
+
+	return assigned == std::min(options.width, options.height) && total == response.total;
+}
+
+void load(const Options & options, const size_t connection, Results & results) {
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	std::strncpy(address.sun_path, options.socketPath, sizeof(address.sun_path) - 1);
+
+	const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+		std::perror(options.socketPath);
+		results.failed = true;
+		return;
+	}
+
+	// Each message is a request header followed by its costs.
+	const size_t size = size_t(options.width) * options.height;
+	std::vector<std::vector<uint32_t>> messages(MATRICES);
+	std::vector<unsigned long> costs(size);
+	for (size_t i = 0; i < MATRICES; ++i) {
+		generator_fill(options.family, generator_mix(generator_mix(options.seed, connection), i), options.width, options.height, costs.data());
+
+		ServiceRequest request;
+		request.length = service_request_length(BATCH_U32, options.width, options.height);
+		request.type = BATCH_U32;
+		request.reserved = 0;
+		request.width = options.width;
+		request.height = options.height;
+
+		messages[i].resize(sizeof(request) / sizeof(uint32_t) + size);
+		std::memcpy(messages[i].data(), &request, sizeof(request));
+		std::copy(costs.begin(), costs.end(), messages[i].begin() + sizeof(request) / sizeof(uint32_t));
+	}
+
+	std::vector<uint64_t> sentAt(options.requests);
+	results.latencies.reserve(options.requests);
+
+	// The sender waits while --depth requests have not been answered.
+	std::mutex lock;
+	std::condition_variable answered;
+	size_t sent = 0, received = 0;
+	bool failed = false;
+
+	// Shuts the socket down, so that neither side waits for the other.
+	auto fail = [&]{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			if (!failed) shutdown(fd, SHUT_RDWR);
+			failed = true;
+		}
+		answered.notify_all();
+	};
+
+	std::thread receiver([&]{
+		std::vector<uint32_t> columns(options.height);
+
+		while (received < options.requests) {
+			ServiceResponse response;
+			if (!service_read(fd, &response, sizeof(response)) || response.height != options.height
+			    || !service_read(fd, columns.data(), columns.size() * sizeof(uint32_t))) {
+				fail();
+				return;
+			}
+
+			uint64_t start;
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				if (response.id >= sent) break;
+				start = sentAt[response.id];
+				++received;
+			}
+			answered.notify_all();
+
+			results.latencies.push_back(timing_seconds(start, timing_now()));
+
+			const uint32_t * const matrix = messages[response.id % MATRICES].data() + sizeof(ServiceRequest) / sizeof(uint32_t);
+			if (!valid(options, matrix, response, columns)) ++results.wrong;
+		}
+
+		// A response to a request that was not sent.
+		if (received < options.requests) fail();
+	});
+
+	for (size_t i = 0; i < options.requests; ++i) {
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			answered.wait(guard, [&]{ return failed || sent - received < options.depth; });
+			if (failed) break;
+			sentAt[i] = timing_now();
+			sent = i + 1;
+		}
+
+		// The receiver only reads the costs of the messages, not their ids.
+		std::vector<uint32_t> & message = messages[i % MATRICES];
+		reinterpret_cast<ServiceRequest *>(message.data())->id = uint32_t(i);
+		if (!service_write(fd, message.data(), message.size() * sizeof(uint32_t))) {
+			fail();
+			break;
+		}
+	}
+	receiver.join();
+
+	if (failed) {
+		std::cerr << "Connection " << connection << " failed\n";
+		results.failed = true;
+	}
+	close(fd);
+}
+
+
+int usage() {
+	std::cerr << "Usage: apsoload [--socket PATH] [--connections N] [--requests N] [--depth N]\n"
+	          << "                [--size WIDTHxHEIGHT] [--family F] [--seed N]\n";
+	return 1;
+}
+
+int main(int argc, char ** argv) {
+	Options options;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+
+		if (arg == "--socket" && i + 1 < argc) {
+			options.socketPath = argv[++i];
+		} else if (arg == "--connections" && i + 1 < argc) {
+			options.connections = std::stoull(argv[++i]);
+		} else if (arg == "--requests" && i + 1 < argc) {
+			options.requests = std::stoull(argv[++i]);
+		} else if (arg == "--depth" && i + 1 < argc) {
+			options.depth = std::stoull(argv[++i]);
+		} else if (arg == "--size" && i + 1 < argc) {
+			if (std::sscanf(argv[++i], "%ux%u", &options.width, &options.height) != 2) return usage();
+		} else if (arg == "--family" && i + 1 < argc) {
+			options.family = generator_parse(argv[++i]);
+			if (options.family == GENERATOR_FAMILIES) return usage();
+		} else if (arg == "--seed" && i + 1 < argc) {
+			options.seed = std::stoull(argv[++i]);
+		} else return usage();
+	}
+
+	ServiceRequest largest = {};
+	largest.type = BATCH_U32;
+	largest.width = options.width;
+	largest.height = options.height;
+	largest.length = service_request_length(BATCH_U32, options.width, options.height);
+	if (!options.connections || !options.requests || !options.depth || !service_request_valid(&largest)
+	    || options.requests > std::numeric_limits<uint32_t>::max())
+		return usage();
+
+	std::vector<Results> results(options.connections);
+	std::vector<std::thread> threads;
+
+	const uint64_t start = timing_now();
+	for (size_t i = 0; i < options.connections; ++i)
+		threads.emplace_back(load, std::cref(options), i, std::ref(results[i]));
+	for (auto & thread : threads)
+		thread.join();
+	const double seconds = timing_seconds(start, timing_now());
+
+	std::vector<double> latencies;
+	size_t wrong = 0;
+	bool failed = false;
+	for (const auto & result : results) {
+		latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+		wrong += result.wrong;
+		failed |= result.failed;
+	}
+	if (latencies.empty()) return 1;
+
+	std::cout << latencies.size() << ' ' << options.width << 'x' << options.height << ' ' << generator_name(options.family)
+	          << " requests over " << options.connections << " connections with " << options.depth << " in flight each\n"
+	          << double(latencies.size()) / seconds << " requests per second\n\nLatency:\n";
+	const TimingSummary summary = timing_summarize(latencies.data(), latencies.size());
+	timing_print(stdout, &summary);
+
+	if (wrong) std::cout << wrong << " responses were not valid assignments\n";
+	return failed || wrong;
+}
@@ -0,0 +1,106 @@
+/*
+The protocol of the APSO service, apsod, over a Unix domain socket.
+
+A client sends requests, each of which is a ServiceRequest followed by
+width * height costs in row-major order, of the type given in the request (see
+Batch/batchfile.h for the types). The service sends a ServiceResponse for each
+request, followed by `height` columns as uint32_t: the column assigned to each
+row, or BATCH_UNASSIGNED.
+
+Every message starts with its length in bytes, not counting the length field
+itself, so a reader always knows how much to read. Everything is in the
+machine's byte order, since both sides are on the same machine.
+
+A client can send many requests without waiting for their responses. The
+responses may come back in a different order, so each one has the id of its
+request. The service stops reading a client's requests while too many of them
+are waiting to be answered (see apsod's --pending), so a client that sends
+many must also read its responses. If a request is not valid, the service
+closes the connection.
+*/
+
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include "../Batch/batchfile.h"
+
+
+#define SERVICE_SOCKET    "apso.sock"
+
+/* The largest matrix the service accepts, in bytes. */
+#define SERVICE_MAX_COSTS (64u << 20)
+
+
+typedef struct {
+	uint32_t length;   /* the size of the rest of the request */
+	uint32_t id;       /* chosen by the client, and copied to the response */
+	uint16_t type;     /* a BatchType */
+	uint16_t reserved; /* 0 */
+	uint32_t width;
+	uint32_t height;
+} ServiceRequest;
+
+typedef struct {
+	uint32_t length;   /* the size of the rest of the response */
+	uint32_t id;       /* the id of the request */
+	uint32_t height;   /* the number of columns that follow */
+	uint32_t reserved; /* 0 */
+	uint64_t total;    /* the total cost, like in a batch result record */
+} ServiceResponse;
+
+
+/* Returns the value of a request's length field. */
+static inline uint32_t service_request_length(BatchType type, uint32_t width, uint32_t height) {
+	return (uint32_t)(sizeof(ServiceRequest) - sizeof(uint32_t) + (size_t)width * height * batch_type_size(type));
+}
+
+/* Returns the value of a response's length field. */
+static inline uint32_t service_response_length(uint32_t height) {
+	return (uint32_t)(sizeof(ServiceResponse) - sizeof(uint32_t) + (size_t)height * sizeof(uint32_t));
+}
+
+/* Returns whether a request's header is valid. */
+static inline int service_request_valid(const ServiceRequest *request) {
+	const size_t typeSize = batch_type_size((BatchType)request->type);
+	return typeSize && request->width && request->height
+	    && (size_t)request->width * request->height <= SERVICE_MAX_COSTS / typeSize
+	    && request->length == service_request_length((BatchType)request->type, request->width, request->height);
+}
+
+
+/* Reads exactly `size` bytes from a socket. Returns 0 if the socket was
+   closed or failed first. */
+static inline int service_read(int fd, void *data, size_t size) {
+	char *bytes = (char *)data;
+	while (size) {
+		const ssize_t got = recv(fd, bytes, size, 0);
+		if (got < 0 && errno == EINTR) continue;
+		if (got <= 0) return 0;
+		bytes += got;
+		size -= (size_t)got;
+	}
+	return 1;
+}
+
+/* Writes all `size` bytes to a socket. Returns 0 if it failed. A closed
+   socket does not raise SIGPIPE. */
+static inline int service_write(int fd, const void *data, size_t size) {
+	const char *bytes = (const char *)data;
+	while (size) {
+		const ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+		if (sent < 0 && errno == EINTR) continue;
+		if (sent <= 0) return 0;
+		bytes += sent;
+		size -= (size_t)sent;
+	}
+	return 1;
+}
+
+
+#endif /* PROTOCOL_H */
@@ -35,6 +35,97 @@ the Maximum RAM Usage is the greater of the following:
 1) sizeof(cost matrix data-type) * (width * height) + sizeof(pointer) * 3
 2) sizeof(char) * (3 * width) + sizeof(bool) + sizeof(pointer) * (25 + 6 * height)
 The first case will only occur if width < height.
+
+
+Phase Timing:
+If APS_PHASE_HOOK is defined before this file is included, it is called as
+APS_PHASE_HOOK(phase, nanoseconds) at the end of each phase of the solver, with
+an APSPhase and how long that phase took. The phases are transposing the
+matrix, reducing it, assigning zeros, drawing lines, updating the matrix, and
+solving it with the small solvers. If APS_PHASE_HOOK is not defined, none of
+this code is compiled.
+
+
+No Copy:
+The pointer constructor copies the matrix, because the APSO changes its values
+as it solves it. Passing APSOView() before the pointer solves the caller's
+values where they are instead:
+	APSO X(APSOView(), values, width, height);
+The values are not changed. The APSO keeps how much it has subtracted from each
+row and column, and subtracts those from each value as it reads it, which saves
+the memory and the pass over it that the copy takes, at the cost of two more
+subtractions for every value read. This is only done for matrices that are not
+taller than they are wide, with values of at most 32 bits, so that the reduced
+values always fit in 64 bits. Other matrices are copied as usual.
+
+
+Initial Matching:
+The constructors take an optional fourth argument, an APSInit, which chooses
+how zeros are assigned before the solver starts, after the matrix is reduced.
+Every row assigned then is a row that does not have to be assigned later by
+moving other assignments around. The default, APSInit::none, assigns nothing
+up front, and leaves the first pass of the solver to assign the first free zero
+of each row as it goes. APSInit::firstZero does that same thing for every row
+first, like the greedyMatch of Kevin L. Stern's solver. APSInit::greedy assigns
+the rows with the fewest zeros first, each to its zero whose column has the
+fewest zeros, which usually assigns more rows. APSInit::transfer assigns each
+column its first zero, as in the column reduction of the Jonker-Volgenant
+algorithm, and then transfers the reduction of each assigned row: the row's
+other costs are lowered to make another zero in it, and the rest of its column
+is raised by the same amount, which gives later rows more ways to move it. None
+of these apply to matrices solved by APSSmall.h.
+
+
+Operation Counts:
+If APS_STATS is defined before this file is included, the APSO also has a
+public APSOStats member named stats, which counts what the solver did: how many
+times it drew lines and updated the matrix, how many times valueSwap was called
+and how deep it recursed, how many assignments needed valueSwap to move other
+assignments, and how many matrix cells were read. Dividing the cells read by
+the size of the matrix gives the number of full matrix sweeps the solve took.
+It also counts how many rows the initial matching assigned.
+
+
+Dual Potentials:
+If APS_POTENTIALS is defined before this file is included, the APSO also has
+public rowPotentials and columnPotentials members, with one value per row and
+column of the original matrix. For every cell,
+	cost[row][column] - rowPotentials[row] - columnPotentials[column] >= 0,
+with equality for every assigned cell. If the matrix is not square, the
+potentials of the unassigned rows or columns are 0, and the others are at most
+0. Together these prove that the assignment is optimal, and checking them only
+takes one pass over the matrix. See Benchmark/certify.h.
+The potentials are exact as long as they fit in a long long.
+
+
+Parallel Rows:
+If APS_PARALLEL_FOR is defined before this file is included, the row reduction
+and the matrix updates of matrices with at least APS_PARALLEL_MIN cells (65536
+by default) are split by rows. APS_PARALLEL_FOR(count, body) must call
+body(first, last) on ranges of rows that together are every row from 0 to
+count, once each, and return when they are all done. The ranges can be run on
+other threads. Yay295/APSScheduler.h defines it to run them on its workers.
+The pointer constructor's copy of the matrix (or its transpose) is split up the
+same way, and is not set to zero first, so on a machine with more than one
+memory node, each row's pages are first touched, and so placed, by the thread
+that copies it. If the same thread gets the same rows every time, as it does
+with APSScheduler, each row is in the memory closest to the thread that reduces
+and updates it. The other constructors solve memory that the caller placed.
+Updating the counts in APS_STATS is not thread safe, so if it is defined too,
+the rows are not split.
+
+
+Huge Pages:
+Each full pass over a large matrix, like the ones that update it, reads
+thousands of 4 KiB pages, and that is more than the TLB can keep the addresses
+of. If APS_HUGE_PAGES is defined before this file is included, the pointer
+constructor's copy of a matrix of at least 2 MiB is put in 2 MiB pages
+instead, so that it takes 512 times fewer TLB entries. It first asks Linux for
+reserved huge pages (see /proc/sys/vm/nr_hugepages), and if there are not
+enough, for memory aligned to 2 MiB that transparent huge pages are asked for
+with madvise(2). That works if /sys/kernel/mm/transparent_hugepage/enabled is
+"always" or "madvise". Smaller copies, and other systems, use the default
+allocator. Benchmark/tlb.cpp counts the TLB misses with and without it.
 */
 
 
@@ -46,13 +137,117 @@ The first case will only occur if width < height.
 
 
 #include <vector>
+#include <limits>
+#include <ostream>
 #include <type_traits>
 #include <numeric>
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <utility>
+#include "APSSmall.h"
 
 
 #define V std::vector // This is undefined at the bottom.
 
 
+enum class APSInit { none, firstZero, greedy, transfer };
+
+inline const char * apsInitName(const APSInit init) {
+	static const char * const names[] = {"none", "first zero", "greedy", "transfer"};
+	return names[size_t(init)];
+}
+
+
+enum class APSPhase { transpose, reduce, assign, drawLines, updateMatrix, small };
+
+inline const char * apsPhaseName(const APSPhase phase) {
+	static const char * const names[] = {"transpose", "reduce", "assign", "draw lines", "update matrix", "small"};
+	return names[size_t(phase)];
+}
+
+
+#ifdef APS_PHASE_HOOK
+#include <chrono>
+
+// Reports the time from its construction to its destruction to APS_PHASE_HOOK.
+class APSPhaseTimer {
+	const APSPhase phase;
+	const std::chrono::steady_clock::time_point start;
+
+	public:
+
+	explicit APSPhaseTimer(const APSPhase newPhase) : phase(newPhase), start(std::chrono::steady_clock::now()) {}
+
+	~APSPhaseTimer() {
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+		APS_PHASE_HOOK(phase, (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+	}
+};
+
+#define APS_PHASE(phase) const APSPhaseTimer apsPhaseTimer(APSPhase::phase) // This is undefined at the bottom.
+#else
+#define APS_PHASE(phase)
+#endif
+
+
+#ifdef APS_STATS
+struct APSOStats {
+	size_t drawLines = 0;      // calls to drawLines
+	size_t updateMatrix = 0;   // calls to updateMatrix
+	size_t valueSwaps = 0;     // calls to valueSwap, including recursive calls
+	size_t valueSwapDepth = 0; // the deepest valueSwap recursion
+	size_t augmentations = 0;  // assignments that moved other assignments
+	size_t cellsScanned = 0;   // matrix cells read
+	size_t initialMatches = 0; // rows assigned by the initial matching
+
+	// Adds another solve's counts to these. The depth is the deepest of both.
+	void add(const APSOStats & other) {
+		drawLines += other.drawLines;
+		updateMatrix += other.updateMatrix;
+		valueSwaps += other.valueSwaps;
+		valueSwapDepth = std::max(valueSwapDepth, other.valueSwapDepth);
+		augmentations += other.augmentations;
+		cellsScanned += other.cellsScanned;
+		initialMatches += other.initialMatches;
+	}
+};
+
+#define APS_STAT(...) __VA_ARGS__ // This is undefined at the bottom.
+#else
+#define APS_STAT(...)
+#endif
+
+
+#if defined(APS_HUGE_PAGES) && defined(__linux__)
+#include <cstdint>
+#include <sys/mman.h>
+#define APS_HUGE_PAGE_SIZE (size_t(2) << 20) // This is undefined at the bottom.
+#endif
+
+
+#ifdef APS_POTENTIALS
+#define APS_DUAL(...) __VA_ARGS__ // This is undefined at the bottom.
+#else
+#define APS_DUAL(...)
+#endif
+
+
+#if defined(APS_PARALLEL_FOR) && !defined(APS_STATS)
+#include <atomic>
+#define APS_PARALLEL // This is undefined at the bottom.
+#endif
+
+#ifndef APS_PARALLEL_MIN
+#define APS_PARALLEL_MIN 65536
+#endif
+
+
+// Passed to the APSO's pointer constructor to solve the values without copying
+// them. See "No Copy" at the top of this file.
+struct APSOView {};
+
+
 struct APSOResult {
 	size_t x, y;
 	APSOResult(const size_t & X, const size_t & Y) : x(X), y(Y) {}
@@ -64,6 +259,15 @@ class APSO {
 
 	V<APSOResult> results;
 
+#ifdef APS_STATS
+	// This is mutable because the functions that update it are const.
+	mutable APSOStats stats;
+#endif
+
+#ifdef APS_POTENTIALS
+	V<long long> rowPotentials, columnPotentials;
+#endif
+
 
 	// Note that since this class has no public member functions
 	// (other than constructors), the only use for this empty constructor
@@ -72,17 +276,41 @@ class APSO {
 
 
 	template<typename T>
-	APSO(const T * const newValues, const size_t newWidth, const size_t newHeight) {
+	APSO(const T * const newValues, const size_t newWidth, const size_t newHeight, const APSInit newInit = APSInit::none) : init(newInit) {
+		typedef typename std::make_unsigned<T>::type U;
 		const size_t nSize = newWidth * newHeight;
+		// What is added to every value to make it unsigned.
+		const unsigned long long shift = toUnsigned(T(0));
+
+		// The copy is left uninitialized and filled a range of rows at a time,
+		// so that its pages are first touched by the threads that will reduce
+		// and update those rows. See "Parallel Rows" at the top of this file.
+		V<U, Uninitialized<U>> values(nSize);
 
 		if (newWidth >= newHeight) { // width >= height -> do not transpose matrix
-			if (std::is_signed<T>::value) {
-				constexpr T max = std::numeric_limits<T>::max();
-				V<typename std::make_unsigned<T>::type> values(nSize);
-				std::transform(newValues, newValues + nSize, values.begin(), [max](T x){return x + max;});
-				math(values, newWidth, newHeight, false);
-			} else math(V<T>(newValues, newValues + nSize), newWidth, newHeight, false);
-		} else math(transposeToUnsigned(newValues, newWidth, newHeight), newHeight, newWidth, true);
+			forRows(newWidth, newHeight, [&](const size_t first, const size_t last) {
+				std::transform(newValues + first*newWidth, newValues + last*newWidth, values.begin() + first*newWidth, toUnsigned<T>);
+			});
+			math(values, newWidth, newHeight, false, shift);
+		} else {
+			transposeToUnsigned(newValues, newWidth, newHeight, values);
+			math(values, newHeight, newWidth, true, shift);
+		}
+	}
+
+
+	// This constructor solves the values where they are, if it can. See "No
+	// Copy" at the top of this file.
+	template<typename T>
+	APSO(APSOView, const T * const newValues, const size_t newWidth, const size_t newHeight, const APSInit newInit = APSInit::none) : init(newInit) {
+		if (sizeof(T) > 4 || newWidth < newHeight) {
+			*this = APSO(newValues, newWidth, newHeight, newInit);
+			return;
+		}
+
+		width = newWidth; height = newHeight;
+		MatrixView<T> matrix(newValues, width, height);
+		solve(matrix, false, toUnsigned(T(0)));
 	}
 
 
@@ -92,13 +320,15 @@ class APSO {
 	// given to it must already be in the form this class uses internally
 	// - a C++ vector of an unsigned integer type.
 	template<typename T>
-	APSO(V<T> & newValues, const size_t newWidth, const size_t newHeight) {
+	APSO(V<T> & newValues, const size_t newWidth, const size_t newHeight, const APSInit newInit = APSInit::none) : init(newInit) {
 		static_assert(!std::numeric_limits<T>::is_signed, "The value type used for the APSO's special constructor must be unsigned.");
 
 		if (newWidth < newHeight) {
 			// Okay, it does technically create a copy here,
 			// but this copy is destroyed after it's been used.
-			newValues = transposeToUnsigned(newValues.data(), newWidth, newHeight);
+			V<T> transposed;
+			transposeToUnsigned(newValues.data(), newWidth, newHeight, transposed);
+			newValues.swap(transposed);
 			math(newValues, newHeight, newWidth, true);
 		} else math(newValues, newWidth, newHeight, false);
 	}
@@ -132,111 +362,406 @@ class APSO {
 	}
 
 
+	// Transposes a `width` x `height` matrix into `output`, mapping its values
+	// to unsigned ones. Reading a column of a row-major matrix misses the cache
+	// on every value once the matrix is large, so it is done in square blocks
+	// small enough that the rows read and the rows written stay in the cache.
+	// Within a block, the writes are in order and the compiler vectorizes them.
+	// Each range of output rows is written by the thread that will process
+	// it, like the APSO's other copies. It is public so that
+	// Benchmark/transpose.cpp can time it alone.
+	template<typename T, typename A>
+	static void transposeToUnsigned(const T * const input, const size_t width, const size_t height,
+	                                V<typename std::make_unsigned<T>::type, A> & output) {
+		APS_PHASE(transpose);
+
+		// 64 was the fastest block size for 8 to 64 bit values on tall
+		// matrices, or close to it. See Benchmark/transpose.cpp.
+		constexpr size_t BLOCK = 64;
+
+		output.resize(width*height);
+		typename std::make_unsigned<T>::type * const values = output.data();
+
+		forRows(height, width, [&](const size_t first, const size_t last) {
+			for (size_t rowBlock = 0; rowBlock < height; rowBlock += BLOCK) {
+				const size_t rowEnd = std::min(rowBlock + BLOCK, height);
+
+				for (size_t columnBlock = first; columnBlock < last; columnBlock += BLOCK) {
+					const size_t columnEnd = std::min(columnBlock + BLOCK, last);
+
+					for (size_t column = columnBlock; column < columnEnd; ++column)
+						for (size_t row = rowBlock; row < rowEnd; ++row)
+							values[column*height+row] = toUnsigned(input[row*width+column]);
+				}
+			}
+		});
+	}
+
+
 	private:
 
 	size_t width, height;
+	APSInit init = APSInit::none;
 
+#ifdef APS_STATS
+	size_t valueSwapDepth = 0; // the current depth of valueSwap
+#endif
 
-	template<typename T>
-	auto transposeToUnsigned(const T * const input, const size_t width, const size_t height) const {
-		// If the input values are signed, add their maximum possible (signed) value to each to
-		// ensure they are positive. Because they are being made unsigned, this operation will not
-		// cause overflow. Since this is a constexpr, it can be evaluated at compile time and
-		// should prevent this operation from being done if the values are already unsigned.
-		constexpr T max = std::numeric_limits<T>::is_signed ? std::numeric_limits<T>::max() : 0;
+#ifdef APS_POTENTIALS
+	// The potentials of the internal matrix. They wrap around like the
+	// unsigned values do. These are mutable because the functions that
+	// update them are const.
+	mutable V<unsigned long long> rowDuals, columnDuals;
+#endif
 
-		V<typename std::make_unsigned<T>::type> values;
-		values.reserve(width*height);
 
-		for (size_t column = 0; column < width; ++column)
-			for (size_t row = 0; row < height; ++row)
-				values.push_back(input[row*width+column] + max);
+	// Maps a value to an unsigned one in the same order. Signed values have
+	// their minimum subtracted, which can not overflow once they are unsigned.
+	// Unsigned values are not changed, and the compiler removes the subtraction.
+	template<typename T>
+	static typename std::make_unsigned<T>::type toUnsigned(const T value) {
+		typedef typename std::make_unsigned<T>::type U;
+		return U(U(value) - U(std::numeric_limits<T>::min()));
+	}
 
-		return values;
+	// Calls body(first, last) on ranges of rows that together are every row
+	// from 0 to height, on APS_PARALLEL_FOR if the matrix is large enough, and
+	// all at once otherwise. See "Parallel Rows" at the top of this file.
+	template<typename Body>
+	static void forRows(const size_t width, const size_t height, const Body & body) {
+#ifdef APS_PARALLEL
+		if (height > 1 && width * height >= APS_PARALLEL_MIN) {
+			APS_PARALLEL_FOR(height, body);
+			return;
+		}
+#endif
+		body(size_t(0), height);
 	}
 
 
+	// An allocator that leaves new values uninitialized, instead of setting
+	// them to zero, so that the pages of a copy are not touched until it is
+	// filled. With APS_HUGE_PAGES, large copies are put in huge pages. See
+	// "Huge Pages" at the top of this file.
 	template<typename T>
-	void math(V<T> && values, const size_t & newWidth, const size_t & newHeight, const bool flip) {
-		// Why is this necessary...
-		math(values, newWidth, newHeight, flip);
-	}
+	struct Uninitialized : std::allocator<T> {
+		template<typename U> struct rebind { typedef Uninitialized<U> other; };
+
+		Uninitialized() {}
+		template<typename U> Uninitialized(const Uninitialized<U> &) {}
+
+		template<typename U> void construct(U * const pointer) { ::new(static_cast<void *>(pointer)) U; }
+		template<typename U, typename... Args> void construct(U * const pointer, Args &&... args) {
+			::new(static_cast<void *>(pointer)) U(std::forward<Args>(args)...);
+		}
+
+#ifdef APS_HUGE_PAGE_SIZE
+		T * allocate(const size_t count) {
+			const size_t bytes = count * sizeof(T);
+			if (bytes < APS_HUGE_PAGE_SIZE) return std::allocator<T>::allocate(count);
+			const size_t size = hugeSize(bytes);
+
+			void * pointer = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if (pointer != MAP_FAILED) return static_cast<T *>(pointer);
+
+			// Transparent huge pages are only used for whole huge pages of
+			// the mapping, so one more is mapped, and the ends are unmapped
+			// to leave a mapping that starts at a multiple of their size.
+			pointer = mmap(nullptr, size + APS_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (pointer == MAP_FAILED) throw std::bad_alloc();
+
+			const uintptr_t start = reinterpret_cast<uintptr_t>(pointer);
+			const uintptr_t aligned = (start + APS_HUGE_PAGE_SIZE - 1) / APS_HUGE_PAGE_SIZE * APS_HUGE_PAGE_SIZE;
+			if (aligned > start) munmap(pointer, aligned - start);
+			if (start + APS_HUGE_PAGE_SIZE > aligned) munmap(reinterpret_cast<void *>(aligned + size), start + APS_HUGE_PAGE_SIZE - aligned);
+
+			madvise(reinterpret_cast<void *>(aligned), size, MADV_HUGEPAGE);
+			return reinterpret_cast<T *>(aligned);
+		}
+
+		void deallocate(T * const pointer, const size_t count) {
+			const size_t bytes = count * sizeof(T);
+			if (bytes < APS_HUGE_PAGE_SIZE) std::allocator<T>::deallocate(pointer, count);
+			else munmap(pointer, hugeSize(bytes));
+		}
+
+		// Rounds a size up to a whole number of huge pages.
+		static size_t hugeSize(const size_t bytes) {
+			return (bytes + APS_HUGE_PAGE_SIZE - 1) / APS_HUGE_PAGE_SIZE * APS_HUGE_PAGE_SIZE;
+		}
+#endif
+	};
+
+
+	// The matrix the solver works on, as a vector of unsigned values that it
+	// changes in place. row() returns a pointer to a row.
+	template<typename T, typename A = std::allocator<T>>
+	class Matrix {
+		V<T, A> & values;
+		const size_t width, height;
+
+		public:
+
+		typedef T Value;
+
+		Matrix(V<T, A> & newValues, const size_t newWidth, const size_t newHeight) : values(newValues), width(newWidth), height(newHeight) {}
+
+		T * row(const size_t row) { return &values[row*width]; }
+		const T * row(const size_t row) const { return &values[row*width]; }
+		const V<T, A> & contiguous() const { return values; }
+
+		void subtractRow(const size_t row, const T min) {
+			T * const rowPtr = this->row(row);
+			for (size_t column = 0; column < width; ++column)
+				rowPtr[column] -= min;
+		}
+
+		void subtractColumn(const size_t column, const T min) {
+			for (size_t row = 0; row < height; ++row)
+				values[row*width+column] -= min;
+		}
+
+		// Subtracts min from the uncovered cells, and adds it to the doubly
+		// covered cells. Each row is updated on its own, so they can be
+		// split up.
+		void update(const V<char> & coveredRows, const V<char> & coveredColumns, const T min) {
+			forRows(width, height, [&](const size_t first, const size_t last) {
+				for (size_t row = first; row < last; ++row) {
+					T * const rowPtr = this->row(row);
+
+					if (coveredRows[row]) {
+						for (size_t column = 0; column < width; ++column) {
+							if (coveredColumns[column]) { // add min to each doubly covered cell
+								T & val = rowPtr[column];
+								val += min;
+								if (val < min) // prevent overflow by setting a cap
+									val = std::numeric_limits<T>::max();
+							}
+						}
+					} else {
+						for (size_t column = 0; column < width; ++column) // subtract min from each uncovered cell
+							if (!coveredColumns[column]) rowPtr[column] -= min;
+					}
+				}
+			});
+		}
+
+		// Subtracts min from a row and adds it to a column, except for the
+		// cell where they cross. This is the same as raising the row's
+		// potential and lowering the column's, so no values go below zero
+		// as long as min is the smallest of the rest of the row.
+		void transfer(const size_t row, const size_t column, const T min) {
+			T * const rowPtr = this->row(row);
+			for (size_t other = 0; other < width; ++other)
+				if (other != column) rowPtr[other] -= min;
+
+			for (size_t other = 0; other < height; ++other) {
+				if (other != row) {
+					T & val = values[other*width+column];
+					val += min;
+					if (val < min) // prevent overflow by setting a cap
+						val = std::numeric_limits<T>::max();
+				}
+			}
+		}
+	};
+
+
+	// The caller's values, which are not changed, and how much has been
+	// subtracted from each row and column. A value is read as the original
+	// value, made unsigned, minus its row's and its column's amounts. The
+	// amounts wrap around like the values do, but the values read are the
+	// real reduced values, which are never negative and fit in 64 bits since
+	// the original values have at most 32. Since nothing is capped, the
+	// doubly covered cells always have their real values.
 	template<typename T>
-	void math(V<T> & values, const size_t & newWidth, const size_t & newHeight, const bool flip) {
+	class MatrixView {
+		const T * const values;
+		const size_t width, height;
+		V<unsigned long long> rowOffsets, columnOffsets;
+
+		public:
+
+		typedef unsigned long long Value;
+
+		class Row {
+			const T * const values;
+			const Value offset;
+			const Value * const columnOffsets;
+
+			public:
+
+			Row(const T * const newValues, const Value newOffset, const Value * const newColumnOffsets)
+				: values(newValues), offset(newOffset), columnOffsets(newColumnOffsets) {}
+
+			Value operator[](const size_t column) const {
+				return Value(toUnsigned(values[column])) - offset - columnOffsets[column];
+			}
+		};
+
+		MatrixView(const T * const newValues, const size_t newWidth, const size_t newHeight)
+			: values(newValues), width(newWidth), height(newHeight), rowOffsets(newHeight, 0), columnOffsets(newWidth, 0) {}
+
+		Row row(const size_t row) const { return Row(&values[row*width], rowOffsets[row], columnOffsets.data()); }
+
+		// Only small matrices are read all at once, by the small solvers.
+		V<Value> contiguous() const {
+			V<Value> reduced(width*height);
+			for (size_t row = 0; row < height; ++row)
+				for (size_t column = 0; column < width; ++column)
+					reduced[row*width+column] = this->row(row)[column];
+			return reduced;
+		}
+
+		void subtractRow(const size_t row, const Value min) { rowOffsets[row] += min; }
+		void subtractColumn(const size_t column, const Value min) { columnOffsets[column] += min; }
+
+		void update(const V<char> & coveredRows, const V<char> & coveredColumns, const Value min) {
+			for (size_t row = 0; row < height; ++row)
+				if (!coveredRows[row]) rowOffsets[row] += min;
+			for (size_t column = 0; column < width; ++column)
+				if (coveredColumns[column]) columnOffsets[column] -= min;
+		}
+
+		void transfer(const size_t row, const size_t column, const Value min) {
+			rowOffsets[row] += min;
+			columnOffsets[column] -= min;
+		}
+	};
+
+
+
+	template<typename T, typename A>
+	void math(V<T, A> & values, const size_t & newWidth, const size_t & newHeight, const bool flip, const unsigned long long shift = 0) {
 		static_assert(!std::numeric_limits<T>::is_signed, "A signed value type was passed to the APSO's math() function.");
 
 		width = newWidth; height = newHeight;
+		Matrix<T, A> matrix(values, width, height);
+		solve(matrix, flip, shift);
+	}
+
+	// Solves a Matrix or a MatrixView. The width and height must be set.
+	template<typename M>
+	void solve(M & matrix, const bool flip, const unsigned long long shift) {
 		results.reserve(height);
+		APS_DUAL(rowDuals.assign(height, 0); columnDuals.assign(width, 0));
 
-		rowReduce(values);
-		if (width == height) columnReduce(values);
+		{
+			APS_PHASE(reduce);
+			rowReduce(matrix);
+			if (width == height) columnReduce(matrix);
+		}
 
-		getResults(values);
+		if (width <= APS_SMALL_MAX) smallResults(matrix);
+		else getResults(matrix);
 
 		// This is true if the matrix was flipped. Matrices are flipped
 		// if they are taller than they are wide. This improves speed and
 		// decreases code size. The results are then flipped to be correct.
 		if (flip) for (auto & result : results)
 			std::swap(result.x, result.y);
+
+#ifdef APS_POTENTIALS
+		// Every internal row is assigned, so the shift that was added to
+		// every value can be taken out of the row potentials.
+		rowPotentials.resize(height);
+		for (size_t row = 0; row < height; ++row)
+			rowPotentials[row] = (long long)(rowDuals[row] - shift);
+		columnPotentials.assign(columnDuals.begin(), columnDuals.end());
+		if (flip) std::swap(rowPotentials, columnPotentials);
+#endif
 	}
 
 
-	template<typename T>
-	void rowReduce(V<T> & values) const {
-		size_t row, column;
-		T min;
+	template<typename M>
+	void rowReduce(M & matrix) const {
+		// Each row is reduced on its own, so they can be split up.
+		forRows(width, height, [&](const size_t first, const size_t last) {
+			size_t row, column;
+			typename M::Value min;
 
-		for (row = 0; row < height; ++row) { // traverse rows
-			T * rowPtr = &values[row*width];
+			for (row = first; row < last; ++row) { // traverse rows
+				const auto rowPtr = matrix.row(row);
 
-			min = rowPtr[0];
+				min = rowPtr[0];
+				APS_STAT(++stats.cellsScanned);
 
-			if (min) {
-				for (column = 1; column < width; ++column) { // find smallest number in row
-					if (rowPtr[column] < min) {
-						min = rowPtr[column];
-						if (!min) break;
+				if (min) {
+					for (column = 1; column < width; ++column) { // find smallest number in row
+						if (rowPtr[column] < min) {
+							min = rowPtr[column];
+							if (!min) break;
+						}
 					}
-				}
+					APS_STAT(stats.cellsScanned += std::min(column, width - 1));
 
-				if (min) {
-					for (column = 0; column < width; ++column) { // subtract all by that num
-						rowPtr[column] -= min;
+					if (min) {
+						matrix.subtractRow(row, min); // subtract all by that num
+						APS_STAT(stats.cellsScanned += width);
+						APS_DUAL(rowDuals[row] += min);
 					}
 				}
 			}
-		}
+		});
 	}
 
 
-	template<typename T>
-	void columnReduce(V<T> & values) const {
+	template<typename M>
+	void columnReduce(M & matrix) const {
 		size_t column, row;
-		T min;
+		typename M::Value min;
 
 		for (column = 0; column < width; ++column) { // traverse columns
-			min = values[column];
+			min = matrix.row(0)[column];
+			APS_STAT(++stats.cellsScanned);
 
 			if (min) {
 				for (row = 1; row < height; ++row) { // find smallest number in column
-					if (values[row*width+column] < min) {
-						min = values[row*width+column];
+					if (matrix.row(row)[column] < min) {
+						min = matrix.row(row)[column];
 						if (!min) break;
 					}
 				}
+				APS_STAT(stats.cellsScanned += std::min(row, height - 1));
 
 				if (min) {
-					for (row = 0; row < height; ++row) { // subtract all by that num
-						values[row*width+column] -= min;
-					}
+					matrix.subtractColumn(column, min); // subtract all by that num
+					APS_STAT(stats.cellsScanned += height);
+					APS_DUAL(columnDuals[column] += min);
 				}
 			}
 		}
 	}
 
 
-	template<typename T>
-	void getResults(V<T> & values) {
+	template<typename M>
+	void smallResults(const M & matrix) {
+		// Small matrices are solved by a solver made for their exact width.
+		// See APSSmall.h for details.
+		size_t columns[APS_SMALL_MAX + 1];
+		const auto & values = matrix.contiguous();
+
+		APS_PHASE(small);
+
+#ifdef APS_POTENTIALS
+		// The small solvers' potentials are for the reduced matrix, so the
+		// reductions are added to them.
+		APSSmall::Sum rowPotentials[APS_SMALL_MAX], columnPotentials[APS_SMALL_MAX];
+		APSSmall::solve(values.data(), width, height, columns, rowPotentials, columnPotentials);
+		for (size_t row = 0; row < height; ++row) rowDuals[row] += rowPotentials[row];
+		for (size_t column = 0; column < width; ++column) columnDuals[column] += columnPotentials[column];
+#else
+		APSSmall::solve(values.data(), width, height, columns);
+#endif
+		APS_STAT(stats.cellsScanned += width * height);
+
+		for (size_t row = 0; row < height; ++row)
+			results.emplace_back(columns[row],row);
+	}
+
+
+	template<typename M>
+	void getResults(M & matrix) {
 		// Here be pointers, goto statements, and recursion. Coders beware.
 
 		/*
@@ -250,58 +775,171 @@ class APSO {
 		4) Else Return
 		*/
 
+		/*
+		The rows visited by valueSwap are only reset once per pass over the
+		rows, so after an assignment has been made, a later row may miss a
+		way to be assigned. Then drawLines can cover a column that will never
+		be assigned. That is fine for square matrices, where every column is
+		assigned in the end, but gives wrong results for matrices wider than
+		they are tall. So for those, the lines are only drawn after a pass
+		that could not assign anything.
+		*/
+
 		V<char> usedRows(height, false), usedColumns(width, false);
 		size_t row = -1, column;
+		bool assigned;
+
+		if (init != APSInit::none) {
+			initialMatch(matrix, usedRows, usedColumns);
+			APS_STAT(stats.initialMatches = results.size());
+			if (results.size() == height) return;
+		}
 
 		while (true) {
-			V<char> forStep2(height, false);
+			{ // The assign phase ends before the lines are drawn.
+				APS_PHASE(assign);
+
+				V<char> forStep2(height, false);
+				assigned = false;
 
-			step1:
+				step1:
 
-			while (++row < height) {
-				if (!usedRows[row]) {
-					const T * rowPtr = &values[row*width];
+				while (++row < height) {
+					if (!usedRows[row]) {
+						const auto rowPtr = matrix.row(row);
 
-					for (column = 0; column < width; ++column) { // skipping step 2
-						if (!usedColumns[column] && !rowPtr[column]) {
-							results.emplace_back(column,row);
+						for (column = 0; column < width; ++column) { // skipping step 2
+							if (!usedColumns[column] && !rowPtr[column]) {
+								APS_STAT(stats.cellsScanned += column + 1);
+								results.emplace_back(column,row);
 
-							usedColumns[column] = true; usedRows[row] = true;
+								usedColumns[column] = true; usedRows[row] = true;
+								assigned = true;
 
-							if (results.size() != height) goto step1; // Step 3
+								if (results.size() != height) goto step1; // Step 3
 
-							else return; // Step 4
+								else return; // Step 4
+							}
 						}
-					}
 
-					forStep2[row] = true;
+						APS_STAT(stats.cellsScanned += width);
+						forStep2[row] = true;
 
-					for (column = 0; column < width; ++column) { // using step 2
-						if (!rowPtr[column]) {
-							results.emplace_back(column,row);
+						for (column = 0; column < width; ++column) { // using step 2
+							if (!rowPtr[column]) {
+								results.emplace_back(column,row);
 
-							if (valueSwap(values, forStep2, usedColumns, column, row)) { // Step 2
-								usedRows[row] = true;
+								if (valueSwap(matrix, forStep2, usedColumns, column, row)) { // Step 2
+									APS_STAT(stats.cellsScanned += column + 1; ++stats.augmentations);
+									usedRows[row] = true;
+									assigned = true;
 
-								if (results.size() != height) goto step1; // Step 3
+									if (results.size() != height) goto step1; // Step 3
 
-								else return; // Step 4
-							}
+									else return; // Step 4
+								}
 
-							results.pop_back();
+								results.pop_back();
+							}
 						}
+						APS_STAT(stats.cellsScanned += width);
 					}
 				}
 			}
 
-			drawLines(values);
+			if (!assigned || width == height) drawLines(matrix);
 			row = -1;
 		}
 	}
 
 
-	template<typename T>
-	bool valueSwap(const V<T> & values, V<char> & visitedRows, V<char> & usedColumns,
+	template<typename M>
+	void initialMatch(M & matrix, V<char> & usedRows, V<char> & usedColumns) {
+		// Assigns zeros before getResults starts. See "Initial Matching" at
+		// the top of this file.
+		APS_PHASE(assign);
+		APS_STAT(stats.cellsScanned += width * height);
+
+		const auto assign = [&](const size_t column, const size_t row) {
+			results.emplace_back(column,row);
+			usedColumns[column] = true; usedRows[row] = true;
+		};
+
+		if (init == APSInit::firstZero) {
+			for (size_t row = 0; row < height; ++row) {
+				const auto rowPtr = matrix.row(row);
+				for (size_t column = 0; column < width; ++column) {
+					if (!usedColumns[column] && !rowPtr[column]) {
+						assign(column,row);
+						break;
+					}
+				}
+			}
+		}
+
+		else if (init == APSInit::greedy) {
+			V<size_t> rowZeros(height, 0), columnZeros(width, 0), order(height);
+			for (size_t row = 0; row < height; ++row) {
+				const auto rowPtr = matrix.row(row);
+				for (size_t column = 0; column < width; ++column) {
+					if (!rowPtr[column]) {
+						++rowZeros[row];
+						++columnZeros[column];
+					}
+				}
+			}
+
+			// The rows with the fewest zeros have the fewest ways to be
+			// assigned, so they go first. Stable, so ties keep their order.
+			std::iota(order.begin(), order.end(), size_t(0));
+			std::stable_sort(order.begin(), order.end(), [&](const size_t a, const size_t b){ return rowZeros[a] < rowZeros[b]; });
+
+			for (const size_t row : order) {
+				const auto rowPtr = matrix.row(row);
+				size_t best = width;
+				for (size_t column = 0; column < width; ++column)
+					if (!usedColumns[column] && !rowPtr[column] && (best == width || columnZeros[column] < columnZeros[best]))
+						best = column;
+				if (best != width) assign(best,row);
+			}
+		}
+
+		else if (init == APSInit::transfer) {
+			// Find the first row with a zero in each column.
+			V<size_t> firstRow(width, height);
+			for (size_t row = 0; row < height; ++row) {
+				const auto rowPtr = matrix.row(row);
+				for (size_t column = 0; column < width; ++column)
+					if (!rowPtr[column] && firstRow[column] == height)
+						firstRow[column] = row;
+			}
+
+			// Like the Jonker-Volgenant algorithm, the last column wins.
+			for (size_t column = width; column-- > 0;)
+				if (firstRow[column] != height && !usedRows[firstRow[column]])
+					assign(column,firstRow[column]);
+
+			typedef typename M::Value Value;
+
+			for (const auto & result : results) {
+				const auto rowPtr = matrix.row(result.y);
+
+				Value min = std::numeric_limits<Value>::max();
+				for (size_t column = 0; column < width; ++column)
+					if (column != result.x && rowPtr[column] < min)
+						min = rowPtr[column];
+				if (!min || min == std::numeric_limits<Value>::max()) continue;
+
+				matrix.transfer(result.y, result.x, min);
+				APS_STAT(stats.cellsScanned += 2 * width + height);
+				APS_DUAL(rowDuals[result.y] += min; columnDuals[result.x] -= min);
+			}
+		}
+	}
+
+
+	template<typename M>
+	bool valueSwap(const M & matrix, V<char> & visitedRows, V<char> & usedColumns,
 				   const size_t x, const size_t y) {
 		// Values x and y are the position of the newly assigned zero.
 		// There is no need to ever check already visited rows, so we skip them.
@@ -319,6 +957,12 @@ class APSO {
 		// column. It returns false otherwise.
 
 
+		APS_STAT(
+			++stats.valueSwaps;
+			stats.valueSwapDepth = std::max(stats.valueSwapDepth, ++valueSwapDepth);
+			struct Leave { size_t & depth; ~Leave() { --depth; } } leave{valueSwapDepth};
+		);
+
 		APSOResult * conflict = nullptr;
 
 		for (auto & result : results) { // find conflicting assignment
@@ -332,18 +976,20 @@ class APSO {
 
 
 		size_t column;
-		const T * rowPtr = &values[conflict->y*width];
+		const auto rowPtr = matrix.row(conflict->y);
 
 		visitedRows[conflict->y] = true;
 
 
 		for (column = 0; column < width; ++column) { // find another zero in the same row, in an unused column
 			if (!usedColumns[column] && !rowPtr[column]) {
+				APS_STAT(stats.cellsScanned += column + 1);
 				conflict->x = column;
 				usedColumns[column] = true;
 				return true;
 			}
 		}
+		APS_STAT(stats.cellsScanned += width);
 
 		// OR
 
@@ -351,19 +997,20 @@ class APSO {
 			if (usedColumns[column] && !rowPtr[column]) {
 				conflict->x = column;
 
-				if (valueSwap(values, visitedRows, usedColumns, column, conflict->y))
+				if (valueSwap(matrix, visitedRows, usedColumns, column, conflict->y))
 					return true;
 
 				conflict->x = x;
 			}
 		}
+		APS_STAT(stats.cellsScanned += width);
 
 		return false;
 	}
 
 
-	template<typename T>
-	void drawLines(V<T> & values) const {
+	template<typename M>
+	void drawLines(M & matrix) const {
 		/*
 		This function uses the method detailed below. You can also watch a
 		lecture of it here: https://www.youtube.com/watch?v=BUGIhEecipE&t=895
@@ -393,77 +1040,109 @@ class APSO {
 		V<char> coveredRows(height, false), coveredColumns(width, false);
 		bool newLine;
 
-		for (const auto & result : results) // Modified Step 1
-			coveredRows[result.y] = true;
+		APS_STAT(++stats.drawLines);
 
-		do {
-			newLine = false;
+		{ // The draw lines phase ends before the matrix is updated.
+			APS_PHASE(drawLines);
 
-			for (size_t row = 0; row < height; ++row) { // Modified Step 2
-				if (!coveredRows[row]) {
-					const T * rowPtr = &values[row*width];
+			for (const auto & result : results) // Modified Step 1
+				coveredRows[result.y] = true;
 
-					for (size_t column = 0; column < width; ++column) {
-						if (!coveredColumns[column] && !rowPtr[column]) {
-							coveredColumns[column] = true; // a
-							newLine = true;
+			do {
+				newLine = false;
 
-							for (const auto & result : results) {
-								if (result.x == column) { // b
-									coveredRows[result.y] = false;
-									break;
+				for (size_t row = 0; row < height; ++row) { // Modified Step 2
+					if (!coveredRows[row]) {
+						const auto rowPtr = matrix.row(row);
+
+						size_t column;
+
+						for (column = 0; column < width; ++column) {
+							if (!coveredColumns[column] && !rowPtr[column]) {
+								coveredColumns[column] = true; // a
+								newLine = true;
+
+								for (const auto & result : results) {
+									if (result.x == column) { // b
+										coveredRows[result.y] = false;
+										break;
+									}
 								}
-							}
 
-							break;
+								break;
+							}
 						}
+						APS_STAT(stats.cellsScanned += std::min(column + 1, width));
 					}
 				}
-			}
-		} while (newLine); // Modified Step 3
+			} while (newLine); // Modified Step 3
+		}
 
-		updateMatrix(values, coveredRows, coveredColumns);
+		updateMatrix(matrix, coveredRows, coveredColumns);
 	}
 
 
-	template<typename T>
-	void updateMatrix(V<T> & values, const V<char> & coveredRows, const V<char> & coveredColumns) const {
-		size_t row, column;
-		T * rowPtr, min = std::numeric_limits<T>::max();
-
-		for (row = 0; row < height; ++row) { // get smallest uncovered value
-			if (!coveredRows[row]) {
-				rowPtr = &values[row*width];
+	template<typename M>
+	void updateMatrix(M & matrix, const V<char> & coveredRows, const V<char> & coveredColumns) const {
+		typedef typename M::Value Value;
+		Value min = std::numeric_limits<Value>::max();
 
-				for (column = 0; column < width; ++column)
-					if (!coveredColumns[column] && rowPtr[column] < min)
-						min = rowPtr[column];
-			}
-		}
+		APS_PHASE(updateMatrix);
+		APS_STAT(++stats.updateMatrix; stats.cellsScanned += width * height);
 
+		// Returns the smallest uncovered value in a range of rows.
+		const auto rangeMin = [&](const size_t first, const size_t last) {
+			Value min = std::numeric_limits<Value>::max();
 
-		for (row = 0; row < height; ++row) {
-			rowPtr = &values[row*width];
+			for (size_t row = first; row < last; ++row) {
+				if (!coveredRows[row]) {
+					APS_STAT(stats.cellsScanned += width);
+					const auto rowPtr = matrix.row(row);
 
-			if (coveredRows[row]) {
-				for (column = 0; column < width; ++column) {
-					if (coveredColumns[column]) { // add min to each doubly covered cell
-						T & val = rowPtr[column];
-						val += min;
-						if (val < min) // prevent overflow by setting a cap
-							val = std::numeric_limits<T>::max();
-					}
+					for (size_t column = 0; column < width; ++column)
+						if (!coveredColumns[column] && rowPtr[column] < min)
+							min = rowPtr[column];
 				}
-			} else {
-				for (column = 0; column < width; ++column) // subtract min from each uncovered cell
-					if (!coveredColumns[column]) rowPtr[column] -= min;
 			}
-		}
+
+			return min;
+		};
+
+#ifdef APS_PARALLEL
+		// Each range lowers the shared minimum to its own, if it is lower.
+		std::atomic<Value> sharedMin(min);
+		forRows(width, height, [&](const size_t first, const size_t last) {
+			const Value ownMin = rangeMin(first, last);
+			Value current = sharedMin.load();
+			while (ownMin < current && !sharedMin.compare_exchange_weak(current, ownMin));
+		});
+		min = sharedMin.load();
+#else
+		min = rangeMin(0, height);
+#endif
+
+
+#ifdef APS_POTENTIALS
+		// Subtracting min from the uncovered rows and adding it back to the
+		// covered columns is the same as raising the uncovered rows'
+		// potentials and lowering the covered columns'.
+		for (size_t row = 0; row < height; ++row)
+			if (!coveredRows[row]) rowDuals[row] += min;
+		for (size_t column = 0; column < width; ++column)
+			if (coveredColumns[column]) columnDuals[column] -= min;
+#endif
+
+		matrix.update(coveredRows, coveredColumns, min);
 	}
 };
 
 
 #undef V
+#undef APS_PHASE
+#undef APS_STAT
+#undef APS_DUAL
+#undef APS_PARALLEL
+#undef APS_HUGE_PAGE_SIZE
 
 
 #endif /* APS */
@@ -0,0 +1,267 @@
+/*
+Assignment by Components
+
+
+Usage:
+Many cost matrices are made of blocks that have nothing to do with each other:
+the costs between a row of one block and a column of another are so high that
+no good assignment uses them. Such a matrix can be solved one block at a time,
+and the blocks can be solved at the same time. APSOComponents does this:
+	APSOComponents X(values, width, height, threshold);
+Like the APSO, it then has a vector of APSOResult objects named results. It
+takes an optional fifth argument, the number of threads to use, which is the
+number of CPUs by default. Programs using it must be built with -pthread.
+
+A cost is a candidate if it is at most the threshold, or if it is the smallest
+cost of its row or its column. The rows and columns are split into the
+connected components of the graph of their candidate costs with a union-find,
+and then each component is solved by its own APSO, on a pool of threads, the
+largest components first.
+
+That is only a guess, though, because the best assignment might still use a
+cost that is not a candidate. So the dual potentials of the components (see
+"Dual Potentials" in APS.h) are put together, and checked against every cost
+of the whole matrix. If they pass, they prove that the assignment is optimal.
+If they do not, or a component can not assign all of its rows (or columns, if
+the matrix is taller than it is wide), the whole matrix is solved by one APSO
+instead. Either way, the results are optimal. `decomposed` is true if they
+came from the components, and `components` is how many there were.
+
+The potentials are public too, as rowPotentials and columnPotentials, and mean
+the same as the APSO's. Checking them takes one more pass over the matrix, so
+it only pays off when the components are much smaller than the whole matrix.
+
+
+Notes:
+This needs APS_POTENTIALS, so it defines it before including APS.h. If APS.h
+was already included without it, this stops with an error.
+*/
+
+
+#pragma once
+
+
+#ifndef APS_COMPONENTS
+#define APS_COMPONENTS
+
+
+#if defined(APS) && !defined(APS_POTENTIALS)
+#error "APSComponents.h needs APS_POTENTIALS to be defined before APS.h is included."
+#endif
+
+#ifndef APS_POTENTIALS
+#define APS_POTENTIALS
+#endif
+
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+#include "APS.h"
+
+
+class APSOComponents {
+	public:
+
+	std::vector<APSOResult> results;
+	std::vector<long long> rowPotentials, columnPotentials;
+	size_t components = 0;
+	bool decomposed = false;
+
+
+	template<typename T>
+	APSOComponents(const T * const values, const size_t width, const size_t height, const T threshold,
+	               unsigned threads = std::thread::hardware_concurrency()) {
+		if (!width || !height) return;
+		if (!threads) threads = 1;
+
+		std::vector<Component> parts = split(values, width, height, threshold);
+		components = parts.size();
+
+		// Every row of a component must be assigned, or every column if the
+		// matrix is taller than it is wide, or the component needs costs
+		// from outside of it.
+		const bool balanced = std::all_of(parts.begin(), parts.end(), [&](const Component & part) {
+			return width >= height ? part.rows.size() <= part.columns.size() : part.columns.size() <= part.rows.size();
+		});
+
+		if (components > 1 && balanced) {
+			solveComponents(values, width, height, parts, threads);
+			decomposed = certified(values, width, height);
+		}
+
+		if (!decomposed) {
+			const APSO whole(values, width, height);
+			results = whole.results;
+			rowPotentials = whole.rowPotentials;
+			columnPotentials = whole.columnPotentials;
+		}
+	}
+
+
+	private:
+
+	struct Component {
+		std::vector<size_t> rows, columns;
+		std::vector<APSOResult> results;
+	};
+
+
+	// Returns the root of a set, halving the path to it as it goes.
+	static size_t find(std::vector<size_t> & parent, size_t x) {
+		while (parent[x] != x) {
+			parent[x] = parent[parent[x]];
+			x = parent[x];
+		}
+		return x;
+	}
+
+	// Splits the rows and columns into the connected components of their
+	// candidate costs. Rows are 0 to height - 1 in the union-find, and
+	// columns are height to height + width - 1.
+	template<typename T>
+	static std::vector<Component> split(const T * const values, const size_t width, const size_t height, const T threshold) {
+		std::vector<T> rowMins(height, std::numeric_limits<T>::max()), columnMins(width, std::numeric_limits<T>::max());
+		for (size_t row = 0; row < height; ++row) {
+			const T * const rowPtr = &values[row*width];
+			for (size_t column = 0; column < width; ++column) {
+				rowMins[row] = std::min(rowMins[row], rowPtr[column]);
+				columnMins[column] = std::min(columnMins[column], rowPtr[column]);
+			}
+		}
+
+		std::vector<size_t> parent(height + width);
+		std::iota(parent.begin(), parent.end(), size_t(0));
+
+		for (size_t row = 0; row < height; ++row) {
+			const T * const rowPtr = &values[row*width];
+			for (size_t column = 0; column < width; ++column) {
+				const T value = rowPtr[column];
+				if (value <= threshold || value == rowMins[row] || value == columnMins[column]) {
+					const size_t a = find(parent, row), b = find(parent, height + column);
+					if (a != b) parent[a] = b;
+				}
+			}
+		}
+
+		std::vector<size_t> index(height + width, size_t(-1));
+		std::vector<Component> parts;
+		for (size_t node = 0; node < height + width; ++node) {
+			size_t & part = index[find(parent, node)];
+			if (part == size_t(-1)) {
+				part = parts.size();
+				parts.emplace_back();
+			}
+			if (node < height) parts[part].rows.push_back(node);
+			else parts[part].columns.push_back(node - height);
+		}
+
+		return parts;
+	}
+
+	// Solves every component with an APSO, on `threads` threads, and puts
+	// their results and potentials together.
+	template<typename T>
+	void solveComponents(const T * const values, const size_t width, const size_t height,
+	                     std::vector<Component> & parts, const unsigned threads) {
+		// The largest components go first, so that the threads finish at
+		// about the same time.
+		std::sort(parts.begin(), parts.end(), [](const Component & a, const Component & b) {
+			return a.rows.size() * a.columns.size() > b.rows.size() * b.columns.size();
+		});
+
+		// Columns and rows that are not in any assignment keep a potential
+		// of zero.
+		rowPotentials.assign(height, 0);
+		columnPotentials.assign(width, 0);
+
+		std::atomic<size_t> next(0);
+		const auto work = [&] {
+			std::vector<T> costs;
+
+			for (size_t i; (i = next++) < parts.size();) {
+				Component & part = parts[i];
+				const size_t partWidth = part.columns.size(), partHeight = part.rows.size();
+				if (!partWidth || !partHeight) continue;
+
+				costs.resize(partWidth * partHeight);
+				for (size_t row = 0; row < partHeight; ++row)
+					for (size_t column = 0; column < partWidth; ++column)
+						costs[row*partWidth+column] = values[part.rows[row]*width+part.columns[column]];
+
+				const APSO apso(costs.data(), partWidth, partHeight);
+
+				for (const auto & result : apso.results)
+					part.results.emplace_back(part.columns[result.x], part.rows[result.y]);
+
+				// A square component's potentials can move between its rows
+				// and columns. If the whole matrix is not square, its longer
+				// side's potentials must be at most zero, so they are moved
+				// until the largest is zero.
+				long long shift = 0;
+				if (partWidth == partHeight && width > height)
+					shift = -*std::max_element(apso.columnPotentials.begin(), apso.columnPotentials.end());
+				else if (partWidth == partHeight && width < height)
+					shift = *std::max_element(apso.rowPotentials.begin(), apso.rowPotentials.end());
+
+				for (size_t row = 0; row < partHeight; ++row)
+					rowPotentials[part.rows[row]] = apso.rowPotentials[row] - shift;
+				for (size_t column = 0; column < partWidth; ++column)
+					columnPotentials[part.columns[column]] = apso.columnPotentials[column] + shift;
+			}
+		};
+
+		std::vector<std::thread> pool;
+		for (unsigned thread = 1; thread < std::min<size_t>(threads, parts.size()); ++thread)
+			pool.emplace_back(work);
+		work();
+		for (auto & thread : pool)
+			thread.join();
+
+		results.clear();
+		for (const auto & part : parts)
+			results.insert(results.end(), part.results.begin(), part.results.end());
+		std::sort(results.begin(), results.end(), [](const APSOResult & a, const APSOResult & b) { return a.y < b.y; });
+	}
+
+	// Returns whether the potentials prove that the results are optimal: no
+	// cost minus its row's and column's potentials is negative, those of the
+	// assigned costs are zero, and the potentials of the longer side are at
+	// most zero, and zero if they are not assigned. See Benchmark/certify.h.
+	template<typename T>
+	bool certified(const T * const values, const size_t width, const size_t height) const {
+		if (results.size() != std::min(width, height)) return false;
+
+		for (size_t row = 0; row < height; ++row) {
+			const T * const rowPtr = &values[row*width];
+			for (size_t column = 0; column < width; ++column)
+				if (__int128(rowPtr[column]) - rowPotentials[row] - columnPotentials[column] < 0)
+					return false;
+		}
+
+		std::vector<char> assignedRows(height, false), assignedColumns(width, false);
+		for (const auto & result : results) {
+			if (__int128(values[result.y*width+result.x]) - rowPotentials[result.y] - columnPotentials[result.x] != 0)
+				return false;
+			assignedRows[result.y] = assignedColumns[result.x] = true;
+		}
+
+		if (width > height) {
+			for (size_t column = 0; column < width; ++column)
+				if (columnPotentials[column] > 0 || (!assignedColumns[column] && columnPotentials[column] != 0))
+					return false;
+		} else if (height > width) {
+			for (size_t row = 0; row < height; ++row)
+				if (rowPotentials[row] > 0 || (!assignedRows[row] && rowPotentials[row] != 0))
+					return false;
+		}
+
+		return true;
+	}
+};
+
+
+#endif /* APS_COMPONENTS */
@@ -0,0 +1,425 @@
+/*
+Work Stealing Scheduler
+
+
+Usage:
+A batch of matrices of very different sizes does not split evenly between
+threads: a thread given one 2000x2000 matrix is still working long after the
+threads given thousands of 20x20 ones have finished. APSScheduler runs tasks on
+a pool of worker threads, and a worker that runs out of tasks takes them from
+the others instead of waiting:
+	APSScheduler scheduler(threads);
+	for (...)
+		scheduler.submit([=]{ ... APSO(...) ... });
+	scheduler.wait();
+The number of threads is the number of CPUs by default. Tasks must not throw.
+Programs using it must be built with -pthread.
+
+Each worker has its own queue. Tasks submitted from outside the pool are dealt
+to the queues in turn, so submitting the largest first spreads them out best.
+A worker runs the tasks in its own queue in order, and when it is empty, takes
+the oldest task from another worker's queue.
+
+This file also defines APS_PARALLEL_FOR before including APS.h (see "Parallel
+Rows" there), so an APSO solved by a worker splits the copy, reduction, and
+updates of a large matrix into subtasks, one range of rows each. Each worker
+has a second queue for subtasks, which workers take from before their task
+queues, so idle workers help with a large matrix as soon as they are out of
+small ones. The ranges are dealt to the workers' subtask queues in turn, so
+unless they are taken by another worker, the same rows of a matrix go to the
+same worker every time, and stay in its cache. While a worker waits for its
+subtasks, it runs subtasks too, but no other tasks, so that a large matrix is
+never held up by a whole other solve. An APSO solved outside of the pool is
+not split up.
+
+After wait(), stats() returns what each worker did since the scheduler was
+made: how many tasks and subtasks it ran, how many of those it took from other
+workers, and how long it was busy running tasks. utilization() divides that by
+the time from when the scheduler was made to when wait() last returned.
+
+
+Memory Nodes:
+On a machine with more than one memory node (NUMA), memory is placed on the
+node of the thread that first touches it, and reading another node's memory is
+slower. The APSO's copy of a large matrix is first touched by the workers that
+will process each range of its rows (see "Parallel Rows" in APS.h), but the
+operating system can still move a worker to another node afterwards. Passing
+true as the second argument of the constructor pins each worker to one CPU,
+taking the CPUs the process may run on in order (so `numactl --cpunodebind`
+still applies). This is only done on Linux.
+
+remoteFraction(rows, rowBytes, count) estimates how much of a matrix the
+workers would read from another node: it finds the node of each page of the
+`count` rows with move_pages(2), and returns the fraction of the pages that are
+not on the node of the worker their range of rows is dealt to. It assumes that
+each worker runs its own ranges. Pages that have not been touched yet are not
+counted. It returns -1 if the workers are not pinned or the nodes are not
+known. stats() also has each worker's CPU and node, or -1 if it is not pinned.
+
+
+Notes:
+If APS.h was already included without this file's APS_PARALLEL_FOR, this stops
+with an error.
+*/
+
+
+#pragma once
+
+
+#ifndef APS_SCHEDULER
+#define APS_SCHEDULER
+
+
+#if defined(APS) && !defined(APS_PARALLEL_FOR)
+#error "APSScheduler.h must be included before APS.h."
+#endif
+
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+
+#ifdef __linux__
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+
+class APSScheduler {
+	public:
+
+	struct WorkerStats {
+		size_t tasks = 0;    // tasks run
+		size_t subtasks = 0; // subtasks run, of this worker's tasks or others'
+		size_t steals = 0;   // tasks and subtasks taken from other workers
+		double busySeconds = 0;
+		int cpu = -1, node = -1; // where the worker is pinned
+	};
+
+
+	explicit APSScheduler(unsigned threads = std::thread::hardware_concurrency(), const bool pin = false)
+		: start(std::chrono::steady_clock::now()), end(start) {
+		if (!threads) threads = 1;
+
+		const std::vector<int> cpus = pin ? allowedCPUs() : std::vector<int>();
+		for (unsigned index = 0; index < threads; ++index) {
+			workers.emplace_back(new Worker);
+			if (!cpus.empty()) workers.back()->stats.cpu = cpus[index % cpus.size()];
+		}
+		for (unsigned index = 0; index < threads; ++index)
+			workers[index]->thread = std::thread(&APSScheduler::run, this, index);
+
+		// The workers find their nodes once they are pinned.
+		if (!cpus.empty()) {
+			std::unique_lock<std::mutex> guard(doneLock);
+			done.wait(guard, [this]{ return started.load() == workers.size(); });
+		}
+	}
+
+	~APSScheduler() {
+		wait();
+		{
+			std::lock_guard<std::mutex> guard(sleepLock);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (auto & worker : workers)
+			worker->thread.join();
+	}
+
+	APSScheduler(const APSScheduler &) = delete;
+	APSScheduler & operator=(const APSScheduler &) = delete;
+
+
+	size_t threads() const { return workers.size(); }
+
+	// Adds a task. From a worker, it goes in that worker's queue.
+	void submit(std::function<void()> task) {
+		unfinished.fetch_add(1);
+		const Current & current = this->current();
+		const size_t index = current.scheduler == this ? current.index : nextWorker++ % workers.size();
+		push(index, std::move(task), false);
+	}
+
+	// Returns once every task submitted so far has finished. It must not be
+	// called from a task.
+	void wait() {
+		std::unique_lock<std::mutex> guard(doneLock);
+		done.wait(guard, [this]{ return unfinished.load() == 0; });
+		end = std::chrono::steady_clock::now();
+	}
+
+	std::vector<WorkerStats> stats() const {
+		std::vector<WorkerStats> stats;
+		for (const auto & worker : workers) {
+			std::lock_guard<std::mutex> guard(worker->lock);
+			stats.push_back(worker->stats);
+		}
+		return stats;
+	}
+
+	// The fraction of the time from when the scheduler was made to when
+	// wait() last returned that each worker was busy.
+	std::vector<double> utilization() const {
+		const double seconds = std::chrono::duration<double>(end - start).count();
+		std::vector<double> utilization;
+		for (const auto & stats : this->stats())
+			utilization.push_back(seconds > 0 ? stats.busySeconds / seconds : 0);
+		return utilization;
+	}
+
+
+	// Calls body(first, last) on ranges that together are every index from 0
+	// to count. On a worker, the ranges are subtasks that any worker can run,
+	// dealt to the workers in turn, and this returns once they are all done.
+	// Anywhere else, body is called once with the whole range.
+	template<typename Body>
+	static void parallelFor(const size_t count, const Body & body) {
+		const Current & current = APSScheduler::current();
+		APSScheduler * const scheduler = current.scheduler;
+		if (!scheduler || scheduler->workers.size() == 1 || count < 2) {
+			body(size_t(0), count);
+			return;
+		}
+
+		const size_t ranges = scheduler->rangesOf(count);
+		std::atomic<size_t> remaining(ranges);
+
+		for (size_t range = 0; range < ranges; ++range) {
+			const size_t first = count * range / ranges, last = count * (range + 1) / ranges;
+			scheduler->push(range % scheduler->workers.size(), [&body, &remaining, first, last] {
+				body(first, last);
+				remaining.fetch_sub(1);
+			}, true);
+		}
+
+		while (remaining.load())
+			if (!scheduler->runOne(current.index, true))
+				std::this_thread::yield();
+	}
+
+	// Estimates the fraction of the pages of `count` rows of `rowBytes` bytes
+	// each that are on another node than the worker that their range is dealt
+	// to. See "Memory Nodes" at the top of this file.
+	double remoteFraction(const void * const rows, const size_t rowBytes, const size_t count) const {
+#ifdef __linux__
+		const long pageSize = sysconf(_SC_PAGESIZE);
+		if (pageSize <= 0 || !count) return -1;
+		for (const auto & worker : workers)
+			if (worker->stats.node < 0) return -1;
+
+		const uintptr_t begin = reinterpret_cast<uintptr_t>(rows);
+		const size_t ranges = workers.size() == 1 ? 1 : rangesOf(count);
+		size_t known = 0, remote = 0;
+		std::vector<void *> pages;
+		std::vector<int> nodes;
+
+		for (size_t range = 0; range < ranges; ++range) {
+			// Each page is counted in the range its first byte is in.
+			const uintptr_t first = begin + count * range / ranges * rowBytes, last = begin + count * (range + 1) / ranges * rowBytes;
+			pages.clear();
+			for (uintptr_t page = (first + pageSize - 1) / pageSize * pageSize; page < last; page += pageSize)
+				pages.push_back(reinterpret_cast<void *>(page));
+			if (range == 0 && begin % pageSize) pages.insert(pages.begin(), reinterpret_cast<void *>(begin / pageSize * pageSize));
+			if (pages.empty()) continue;
+
+			// With no nodes to move them to, move_pages only says where they are.
+			nodes.assign(pages.size(), -1);
+			if (syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, nodes.data(), 0) != 0) return -1;
+
+			const int node = workers[range % workers.size()]->stats.node;
+			for (const int pageNode : nodes) {
+				if (pageNode < 0) continue; // not touched yet
+				++known;
+				remote += pageNode != node;
+			}
+		}
+
+		return known ? double(remote) / known : -1;
+#else
+		(void)rows; (void)rowBytes; (void)count;
+		return -1;
+#endif
+	}
+
+
+	private:
+
+	struct Worker {
+		mutable std::mutex lock;
+		std::deque<std::function<void()>> tasks, subtasks;
+		std::thread thread;
+		WorkerStats stats; // only changed by this worker, under its lock
+	};
+
+	// The scheduler and worker of the calling thread, if it is a worker.
+	struct Current {
+		APSScheduler * scheduler = nullptr;
+		size_t index = 0;
+	};
+
+	static Current & current() {
+		static thread_local Current current;
+		return current;
+	}
+
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::atomic<size_t> nextWorker{0};
+
+	// How many tasks and subtasks are queued, which the workers sleep on when
+	// it is zero.
+	std::mutex sleepLock;
+	std::condition_variable wake;
+	std::atomic<size_t> queued{0};
+	bool stopping = false;
+
+	// How many tasks have not finished, which wait() waits on. The
+	// constructor waits on the same condition for the workers to start.
+	std::mutex doneLock;
+	std::condition_variable done;
+	std::atomic<size_t> unfinished{0}, started{0};
+
+	const std::chrono::steady_clock::time_point start;
+	std::chrono::steady_clock::time_point end;
+
+
+	// A few ranges per worker, so that a worker that is busy with something
+	// else still leaves the others enough to do.
+	size_t rangesOf(const size_t count) const {
+		return std::min(count, workers.size() * 4);
+	}
+
+	// The CPUs this process may run on, in order.
+	static std::vector<int> allowedCPUs() {
+		std::vector<int> cpus;
+#ifdef __linux__
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		if (sched_getaffinity(0, sizeof(set), &set) == 0)
+			for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+				if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+#endif
+		return cpus;
+	}
+
+	void push(const size_t index, std::function<void()> && task, const bool subtask) {
+		{
+			Worker & worker = *workers[index];
+			std::lock_guard<std::mutex> guard(worker.lock);
+			(subtask ? worker.subtasks : worker.tasks).push_back(std::move(task));
+		}
+		{
+			std::lock_guard<std::mutex> guard(sleepLock);
+			queued.fetch_add(1);
+		}
+		wake.notify_one();
+	}
+
+	// Takes a task from a queue. A worker takes its own tasks oldest first,
+	// so they run in the order they were submitted, but its own subtasks
+	// newest first, since the newest is the most likely to still be in the
+	// cache. From another worker it takes the oldest of either, since that
+	// is the furthest from what that worker is doing.
+	bool take(const size_t from, const bool own, const bool subtask, std::function<void()> & task) {
+		Worker & worker = *workers[from];
+		std::lock_guard<std::mutex> guard(worker.lock);
+		auto & queue = subtask ? worker.subtasks : worker.tasks;
+		if (queue.empty()) return false;
+
+		if (own && subtask) {
+			task = std::move(queue.back());
+			queue.pop_back();
+		} else {
+			task = std::move(queue.front());
+			queue.pop_front();
+		}
+		queued.fetch_sub(1);
+		return true;
+	}
+
+	// Runs one subtask, or one task if subtasksOnly is false, from worker
+	// `index`'s queues or from another's. Returns whether there was one.
+	// Subtasks only are run while waiting for subtasks, inside of a task
+	// whose time is already being counted, so their time is not counted.
+	bool runOne(const size_t index, const bool subtasksOnly) {
+		std::function<void()> task;
+		const size_t count = workers.size();
+		Worker & worker = *workers[index];
+
+		for (const bool subtask : {true, false}) {
+			if (!subtask && subtasksOnly) break;
+
+			for (size_t offset = 0; offset < count; ++offset) {
+				if (!take((index + offset) % count, offset == 0, subtask, task)) continue;
+
+				const auto started = std::chrono::steady_clock::now();
+				task();
+				const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+				{
+					std::lock_guard<std::mutex> guard(worker.lock);
+					++(subtask ? worker.stats.subtasks : worker.stats.tasks);
+					if (offset) ++worker.stats.steals;
+					if (!subtasksOnly) worker.stats.busySeconds += seconds;
+				}
+
+				if (!subtask) {
+					std::lock_guard<std::mutex> guard(doneLock);
+					if (unfinished.fetch_sub(1) == 1) done.notify_all();
+				}
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void run(const size_t index) {
+		current().scheduler = this;
+		current().index = index;
+
+#ifdef __linux__
+		Worker & worker = *workers[index];
+		if (worker.stats.cpu >= 0) {
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(worker.stats.cpu, &set);
+			unsigned cpu = 0, node = 0;
+			std::lock_guard<std::mutex> guard(worker.lock);
+			if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) worker.stats.cpu = -1;
+			else if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) worker.stats.node = int(node);
+		}
+#endif
+		{
+			std::lock_guard<std::mutex> guard(doneLock);
+			started.fetch_add(1);
+		}
+		done.notify_all();
+
+		while (true) {
+			if (runOne(index, false)) continue;
+
+			std::unique_lock<std::mutex> guard(sleepLock);
+			wake.wait(guard, [this]{ return queued.load() || stopping; });
+			if (stopping && !queued.load()) return;
+		}
+	}
+};
+
+
+#define APS_PARALLEL_FOR(count, body) APSScheduler::parallelFor(count, body)
+#include "APS.h"
+
+
+#endif /* APS_SCHEDULER */
@@ -0,0 +1,228 @@
+/*
+Small Assignment Problem Solvers - Coded by Yay295
+
+
+Usage:
+These solvers are used by the APSO when its (possibly transposed) matrix is at
+most APS_SMALL_MAX columns wide. They can also be called directly through
+APSSmall::solve(), which takes a pointer to a row-major cost matrix, its width,
+its height, and an array that will be filled with the column assigned to each
+row. The matrix must not be taller than it is wide, and all values must be
+unsigned integers.
+
+Each width from 1 to APS_SMALL_MAX gets its own template instantiation, so all
+of the loops over the columns have a constant trip count and can be unrolled.
+Widths up to APS_SMALL_DP_MAX are solved by dynamic programming over the subsets
+of used columns, which is O(2^width * width) but has almost no overhead. Wider
+matrices are solved by a fixed size Hungarian algorithm using row and column
+potentials (O(height^2 * width)).
+
+Defining APS_SMALL_MAX as 0 before including APS.h disables these solvers.
+
+If solve() is given arrays for the row and column potentials, the Hungarian
+algorithm is always used, and its potentials are written to them. They satisfy
+values[row*width+column] - rowPotentials[row] - columnPotentials[column] >= 0,
+with equality for the assigned cells, in wrapping Sum arithmetic.
+
+
+Notes:
+Costs are summed as unsigned long long. The DP saturates instead of overflowing,
+and the Hungarian algorithm uses wrapping arithmetic, which is exact as long as
+the reduced costs it works with fit. The APSO row and column reduces its matrix
+before calling these, so that is only a problem for values near the maximum of
+a 64 bit type.
+*/
+
+
+#pragma once
+
+
+#ifndef APS_SMALL
+#define APS_SMALL
+
+
+#include <array>
+#include <limits>
+#include <utility>
+#include <type_traits>
+
+
+#ifndef APS_SMALL_MAX
+#define APS_SMALL_MAX 16
+#endif
+
+#ifndef APS_SMALL_DP_MAX
+#define APS_SMALL_DP_MAX 2
+#endif
+
+
+namespace APSSmall {
+	typedef unsigned long long Sum;
+
+	constexpr Sum INF = std::numeric_limits<Sum>::max();
+
+
+	// Dynamic programming over the subsets of used columns. Row `r` is always
+	// assigned to the `r`th column added to a subset, so the cost of the best
+	// subset with `r + 1` columns only depends on the best subsets with `r`.
+	template<size_t N, typename T>
+	void subsetDP(const T * const values, const size_t height, size_t * const columns) {
+		constexpr size_t SUBSETS = size_t(1) << N;
+
+		std::array<Sum, SUBSETS> best;
+		std::array<unsigned char, SUBSETS> last; // the column added last to each subset
+
+		best.fill(INF);
+		best[0] = 0;
+
+		Sum finalCost = INF;
+		size_t finalSubset = 0;
+
+		for (size_t subset = 0; subset < SUBSETS; ++subset) {
+			if (best[subset] == INF) continue;
+
+			const size_t row = __builtin_popcountll(subset);
+
+			if (row == height) {
+				if (best[subset] < finalCost) {
+					finalCost = best[subset];
+					finalSubset = subset;
+				}
+				continue;
+			}
+
+			const T * rowPtr = &values[row*N];
+
+			for (size_t column = 0; column < N; ++column) {
+				const size_t next = subset | (size_t(1) << column);
+				if (next == subset) continue;
+
+				Sum cost = best[subset] + rowPtr[column];
+				if (cost < best[subset]) cost = INF - 1; // saturate
+
+				if (cost < best[next]) {
+					best[next] = cost;
+					last[next] = (unsigned char)column;
+				}
+			}
+		}
+
+		for (size_t row = height; row-- > 0;) {
+			columns[row] = last[finalSubset];
+			finalSubset ^= size_t(1) << columns[row];
+		}
+	}
+
+
+	// The Hungarian algorithm with potentials, adding one row at a time and
+	// finding the shortest augmenting path to an unused column. Index 0 of
+	// the arrays is a sentinel column that the new row starts from.
+	template<size_t N, typename T>
+	void hungarian(const T * const values, const size_t height, size_t * const columns,
+	               Sum * const rowPotentials, Sum * const columnPotentials) {
+		std::array<Sum, N+1> u{}, v{}, minv;
+		std::array<size_t, N+1> rowOf{}, way{};
+		std::array<bool, N+1> used;
+
+		for (size_t row = 1; row <= height; ++row) {
+			size_t column = 0;
+
+			rowOf[0] = row;
+			minv.fill(INF);
+			used.fill(false);
+
+			do {
+				used[column] = true;
+
+				const size_t current = rowOf[column];
+				const T * rowPtr = &values[(current-1)*N];
+				Sum delta = INF;
+				size_t nextColumn = 0;
+
+				for (size_t j = 1; j <= N; ++j) {
+					if (!used[j]) {
+						const Sum reduced = rowPtr[j-1] - u[current] - v[j];
+						if (reduced < minv[j]) {
+							minv[j] = reduced;
+							way[j] = column;
+						}
+						if (minv[j] < delta) {
+							delta = minv[j];
+							nextColumn = j;
+						}
+					}
+				}
+
+				for (size_t j = 0; j <= N; ++j) {
+					if (used[j]) {
+						u[rowOf[j]] += delta;
+						v[j] -= delta;
+					} else minv[j] -= delta;
+				}
+
+				column = nextColumn;
+			} while (rowOf[column]);
+
+			do { // flip the augmenting path
+				const size_t previous = way[column];
+				rowOf[column] = rowOf[previous];
+				column = previous;
+			} while (column);
+		}
+
+		for (size_t column = 1; column <= N; ++column)
+			if (rowOf[column]) columns[rowOf[column]-1] = column - 1;
+
+		if (rowPotentials) {
+			for (size_t row = 0; row < height; ++row)
+				rowPotentials[row] = u[row+1];
+			for (size_t column = 0; column < N; ++column)
+				columnPotentials[column] = v[column+1];
+		}
+	}
+
+
+	template<size_t N, typename T>
+	void solveFixed(const T * const values, const size_t height, size_t * const columns,
+	                Sum * const rowPotentials, Sum * const columnPotentials, std::true_type /* use DP */) {
+		// The DP does not find potentials.
+		if (rowPotentials) hungarian<N>(values, height, columns, rowPotentials, columnPotentials);
+		else subsetDP<N>(values, height, columns);
+	}
+
+	template<size_t N, typename T>
+	void solveFixed(const T * const values, const size_t height, size_t * const columns,
+	                Sum * const rowPotentials, Sum * const columnPotentials, std::false_type /* use DP */) {
+		hungarian<N>(values, height, columns, rowPotentials, columnPotentials);
+	}
+
+	template<size_t N, typename T>
+	void solveFixed(const T * const values, const size_t height, size_t * const columns,
+	                Sum * const rowPotentials, Sum * const columnPotentials) {
+		solveFixed<N>(values, height, columns, rowPotentials, columnPotentials, std::integral_constant<bool, (N <= APS_SMALL_DP_MAX)>());
+	}
+
+	template<typename T, size_t... N>
+	bool dispatch(const T * const values, const size_t width, const size_t height, size_t * const columns,
+	              Sum * const rowPotentials, Sum * const columnPotentials, std::index_sequence<N...>) {
+		typedef void (*Solver)(const T *, size_t, size_t *, Sum *, Sum *);
+		static const Solver solvers[] = {nullptr, &solveFixed<N+1, T>...};
+
+		if (width == 0 || width > sizeof...(N) || height > width) return false;
+
+		solvers[width](values, height, columns, rowPotentials, columnPotentials);
+		return true;
+	}
+
+
+	// Solves the matrix if it is small enough, and returns whether it was.
+	template<typename T>
+	bool solve(const T * const values, const size_t width, const size_t height, size_t * const columns,
+	           Sum * const rowPotentials = nullptr, Sum * const columnPotentials = nullptr) {
+		static_assert(!std::numeric_limits<T>::is_signed, "The small solvers only take unsigned value types.");
+		return dispatch(values, width, height, columns, rowPotentials, columnPotentials, std::make_index_sequence<APS_SMALL_MAX>());
+	}
+}
+
+
+#endif /* APS_SMALL */
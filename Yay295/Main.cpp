@@ -2,11 +2,27 @@
 #include <fstream>
 #include <vector>
 #include <string>
-#include <ctime>
 #include <random>
 #include <algorithm>
+#include "../Benchmark/timing.h"
+#include "../Benchmark/generators.h"
+
+// The total time spent in each of the APSO's phases, if it is built by
+// `make phases`. See "Phase Timing" in APS.h.
+unsigned long long phaseTimes[6];
+
+#ifdef PHASES
+#define APS_PHASE_HOOK(phase, nanoseconds) (phaseTimes[size_t(phase)] += (nanoseconds))
+#endif
+
 #include "APS.h"
 
+#ifdef APS_STATS
+// The operation counts of the APSO, summed over the solves of a test, if it
+// is built by `make stats`. See "Operation Counts" in APS.h.
+APSOStats totalStats;
+#endif
+
 // The int type to use to hold the matrix cost data.
 typedef size_t D_TYPE;
 
@@ -16,6 +32,46 @@ const size_t BILLION = MILLION * THOUSAND;
 
 std::vector<D_TYPE> values;
 
+void resetPhases() {
+	std::fill(phaseTimes, phaseTimes + 6, 0);
+}
+
+// Prints the average time spent in each phase over `todo` solves, if the
+// phases were timed.
+void printPhases(const size_t todo) {
+#ifdef PHASES
+	for (size_t phase = 0; phase < 6; ++phase)
+		if (phaseTimes[phase])
+			std::cout << phaseTimes[phase] / 1e9 / todo << "s " << apsPhaseName(APSPhase(phase)) << '\n';
+#endif
+}
+
+void resetStats() {
+#ifdef APS_STATS
+	totalStats = APSOStats();
+#endif
+}
+
+void addStats(const APSO & X) {
+#ifdef APS_STATS
+	totalStats.add(X.stats);
+#endif
+}
+
+// Prints the average operation counts over `todo` `width` x `height` solves,
+// if they were counted.
+void printStats(const size_t todo, const size_t width, const size_t height) {
+#ifdef APS_STATS
+	std::cout << double(totalStats.drawLines) / todo << " draw lines, "
+	          << double(totalStats.updateMatrix) / todo << " update matrix, "
+	          << double(totalStats.valueSwaps) / todo << " value swaps (max depth " << totalStats.valueSwapDepth << "), "
+	          << double(totalStats.augmentations) / todo << " augmentations, "
+	          << double(totalStats.initialMatches) / todo << " initial matches\n"
+	          << double(totalStats.cellsScanned) / todo << " cells scanned ("
+	          << double(totalStats.cellsScanned) / todo / (width * height) << " matrix sweeps)\n";
+#endif
+}
+
 // Tests specific matrices.
 void specificTest() {
 	std::cout << "== Specific Tests ==\n\n";
@@ -44,18 +100,78 @@ void specificTest() {
 	}
 }
 
-// Calculates the result of `todo` `width` x `height` matrices and averages
-// their execution time.
+// Solves the specific test matrices `todo` times each and summarizes their
+// execution times.
+void specificSpeedTest(const size_t todo) {
+	std::cout << "== Specific Speed Test (" << todo << " each) ==\n\n";
+
+	std::vector<std::vector<D_TYPE>> matrices = {
+		{0, 0,
+		 0, 0},
+
+		{0, 0, 0, 0,
+		 0, 0, 0, 0,
+		 0, 0, 0, 0,
+		 0, 0, 0, 1},
+
+		{0, 0, 0, 0, 0,
+		 0, 0, 0, 0, 0,
+		 0, 0, 1, 1, 1,
+		 0, 0, 1, 1, 1,
+		 0, 0, 1, 1, 1}
+	};
+
+	for (const auto & matrix : matrices) {
+		const size_t size = size_t(sqrt(matrix.size()));
+		std::vector<double> times(todo);
+
+		for (size_t total = 0; total < TIMING_WARMUP(todo); ++total) {
+			values = matrix;
+			APSO X(values, size, size);
+		}
+		resetPhases();
+		resetStats();
+
+		for (size_t total = 0; total < todo; ++total) {
+			values = matrix;
+
+			const uint64_t start = timing_now();
+			APSO X(values, size, size);
+			times[total] = timing_seconds(start, timing_now());
+			addStats(X);
+		}
+
+		const TimingSummary summary = timing_summarize(times.data(), todo);
+		std::cout << size << 'x' << size << ":\n";
+		timing_print(stdout, &summary);
+		printPhases(todo);
+		printStats(todo, size, size);
+	}
+
+	std::cout << '\n';
+}
+
+// Calculates the result of `todo` `width` x `height` matrices and summarizes
+// their execution times. Some matrices are solved first without being timed.
 void speedTest(const size_t todo, const size_t width, const size_t height) {
 	std::cout << "== Speed Test (" << todo << ' ' << width << 'x' << height << ") ==\n";
 
 	std::random_device rd;
 	std::mt19937 mt(rd());
 	std::uniform_int_distribution<size_t> random(0, D_TYPE(width * height));
-	clock_t totalTime = 0;
+	std::vector<double> times(todo);
 
 	values.resize(width * height);
 
+	for (size_t total = 0; total < TIMING_WARMUP(todo); ++total) {
+		for (size_t i = 0; i < values.size(); ++i)
+			values[i] = D_TYPE(random(mt));
+
+		APSO X(values, width, height);
+	}
+	resetPhases();
+	resetStats();
+
 	for (size_t total = 1; total <= todo; ++total) {
 		for (size_t i = 0; i < values.size(); ++i)
 			values[i] = D_TYPE(random(mt));
@@ -67,18 +183,102 @@ void speedTest(const size_t todo, const size_t width, const size_t height) {
 		else if (total < BILLION && total % MILLION == 0) std::cout << '\n' << total / MILLION << " Million";
 		else if (total % BILLION == 0) std::cout << '\n' << total / BILLION << " Billion";
 
-		clock_t start = clock();
+		const uint64_t start = timing_now();
 		APSO X(values, width, height);
-		clock_t end = clock();
-		totalTime += end - start;
+		times[total-1] = timing_seconds(start, timing_now());
+		addStats(X);
+	}
+
+	const TimingSummary summary = timing_summarize(times.data(), todo);
+	std::cout << "\n\n";
+	timing_print(stdout, &summary);
+	printPhases(todo);
+	printStats(todo, width, height);
+	std::cout << '\n';
+}
+
+// Solves `todo` `size` x `size` matrices of each family in generators.h and
+// summarizes their execution times.
+void familyTest(const size_t todo, const size_t size) {
+	std::cout << "== Family Test (" << todo << ' ' << size << 'x' << size << ") ==\n\n";
+
+	const uint64_t seed = std::random_device()();
+	std::vector<unsigned long> costs(size * size);
+	std::vector<double> times(todo);
+
+	for (int family = 0; family < GENERATOR_FAMILIES; ++family) {
+		const size_t warmup = TIMING_WARMUP(todo);
+
+		for (size_t run = 0; run < warmup + todo; ++run) {
+			if (run == warmup) {
+				resetPhases();
+				resetStats();
+			}
+
+			generator_fill(GeneratorFamily(family), generator_mix(generator_mix(seed, family), run), size, size, costs.data());
+			values.assign(costs.begin(), costs.end());
+
+			const uint64_t start = timing_now();
+			APSO X(values, size, size);
+			if (run >= warmup) {
+				times[run-warmup] = timing_seconds(start, timing_now());
+				addStats(X);
+			}
+		}
+
+		const TimingSummary summary = timing_summarize(times.data(), todo);
+		std::cout << generator_name(GeneratorFamily(family)) << ":\n";
+		timing_print(stdout, &summary);
+		printPhases(todo);
+		printStats(todo, size, size);
+	}
+
+	std::cout << '\n';
+}
+
+// Solves the same `todo` `size` x `size` matrices with each of the APSO's
+// initial matchings, and summarizes their execution times. Built with `make
+// stats`, this shows how many augmentations each one saves.
+void initTest(const size_t todo, const size_t size) {
+	std::cout << "== Initial Matching Test (" << todo << ' ' << size << 'x' << size << ") ==\n\n";
+
+	const uint64_t seed = std::random_device()();
+	std::vector<unsigned long> costs(size * size);
+	std::vector<double> times(todo);
+
+	for (const APSInit init : {APSInit::none, APSInit::firstZero, APSInit::greedy, APSInit::transfer}) {
+		resetPhases();
+		resetStats();
+
+		for (size_t run = 0; run < todo; ++run) {
+			generator_fill(GENERATOR_UNIFORM, generator_mix(seed, run), size, size, costs.data());
+			values.assign(costs.begin(), costs.end());
+
+			const uint64_t start = timing_now();
+			APSO X(values, size, size, init);
+			times[run] = timing_seconds(start, timing_now());
+			addStats(X);
+		}
+
+		const TimingSummary summary = timing_summarize(times.data(), todo);
+		std::cout << apsInitName(init) << ":\n";
+		timing_print(stdout, &summary);
+		printPhases(todo);
+		printStats(todo, size, size);
 	}
 
-	std::cout << "\n\n" << (totalTime / double(todo)) / CLOCKS_PER_SEC << "s Average Time\n\n";
+	std::cout << '\n';
 }
 
 int main() {
 	specificTest();
+	specificSpeedTest(MILLION);
+	speedTest(10000, 8, 8);
+	speedTest(10000, 16, 16);
 	speedTest(10000, 50, 50);
 	speedTest(100, 250, 250);
 	speedTest(10, 1000, 1000);
+	familyTest(1000, 50);
+	familyTest(10, 250);
+	initTest(100, 250);
 }
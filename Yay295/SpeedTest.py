@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+
+# Compares the APSO Python module with BrianMClapper's munkres.py on the same
+# matrices, the same way as BrianMClapper/SpeedTest.py. Build the module with
+# `make python` first.
+#
+# munkres.py takes most of the time, so there are fewer matrices than in
+# BrianMClapper/SpeedTest.py. The last test solves the APSO's matrices in one
+# batched call, which munkres.py has nothing like.
+
+import array, os, random, sys, time
+
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'BrianMClapper'))
+
+import apso
+from munkres import Munkres
+
+tests = (
+	# todo, size
+	(1000,10),
+	(100,50),
+	(10,250)
+)
+
+def total(matrix, columns):
+	return sum(matrix[row][column] for row, column in enumerate(columns) if column != -1)
+
+# memoryview is used here so that NumPy is not needed. A NumPy array can be
+# passed to apso.solve the same way. A memoryview can not be indexed by its
+# first dimension, so each matrix gets its own view too.
+def buffers(matrices, size):
+	values = memoryview(array.array('q', (value for matrix in matrices for row in matrix for value in row))).cast('B')
+	length = size * size * 8
+	views = [values[i*length:(i+1)*length].cast('q', (size, size)) for i in range(len(matrices))]
+	return values.cast('q', (len(matrices), size, size)), views
+
+for todo, size in tests:
+	max_size = size * size
+	matrices = [[[random.randint(0,max_size) for y in range(size)] for x in range(size)] for i in range(todo)]
+	costs, views = buffers(matrices, size)
+	munkres_time = apso_time = 0
+	wrong = 0
+
+	for i, matrix in enumerate(matrices):
+		start = time.perf_counter()
+		indexes = Munkres().compute(matrix)
+		munkres_time += time.perf_counter() - start
+
+		start = time.perf_counter()
+		columns = apso.solve(views[i])
+		apso_time += time.perf_counter() - start
+
+		if total(matrix, columns) != total(matrix, dict(indexes).values()):
+			wrong += 1
+
+	start = time.perf_counter()
+	apso.solve(costs)
+	batch_time = time.perf_counter() - start
+
+	print('Average Time (', size, 'x', size, '):')
+	print('\tmunkres.py  ', munkres_time / todo)
+	print('\tAPSO        ', apso_time / todo)
+	print('\tAPSO batched', batch_time / todo)
+	print('\tAPSO is', munkres_time / apso_time, 'times faster')
+	if wrong: print('\t', wrong, 'of', todo, 'totals were different')
+	print()
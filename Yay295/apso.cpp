@@ -0,0 +1,166 @@
+// The C interface in apso.h. Build it with `make libapso.so`.
+
+#include <new>
+#include <vector>
+#include <cstring>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+#include <system_error>
+#include <type_traits>
+#include "APSScheduler.h"
+#include "apso.h"
+
+
+// The values the APSO solves in place. Costs of up to 32 bits are solved as
+// 32 bit values, which the APSO is faster with, and the rest as 64 bit values.
+struct apso_workspace {
+	std::vector<uint32_t> values32;
+	std::vector<uint64_t> values64;
+};
+
+
+namespace {
+
+template<typename U> std::vector<U> & valuesOf(apso_workspace & workspace);
+template<> std::vector<uint32_t> & valuesOf(apso_workspace & workspace) { return workspace.values32; }
+template<> std::vector<uint64_t> & valuesOf(apso_workspace & workspace) { return workspace.values64; }
+
+// The costs are read with memcpy, because with byte strides they might not be
+// aligned. It compiles to an ordinary load.
+template<typename T>
+void solve(const char * const costs, const size_t width, const size_t height, const ptrdiff_t rowStride,
+           const ptrdiff_t columnStride, int32_t * const columns, apso_workspace & workspace) {
+	// Contiguous, aligned costs of up to 32 bits are solved where they are,
+	// without a copy. See "No Copy" in APS.h.
+	if (sizeof(T) <= 4 && width >= height && columnStride == ptrdiff_t(sizeof(T)) && rowStride == ptrdiff_t(width * sizeof(T))
+	    && reinterpret_cast<uintptr_t>(costs) % alignof(T) == 0) {
+		const APSO apso(APSOView(), reinterpret_cast<const T *>(costs), width, height);
+
+		std::fill(columns, columns + height, -1);
+		for (const auto & result : apso.results)
+			columns[result.y] = int32_t(result.x);
+		return;
+	}
+
+	typedef typename std::conditional<sizeof(T) <= 4, uint32_t, uint64_t>::type U;
+	std::vector<U> & values = valuesOf<U>(workspace);
+
+	// Flipping the sign bit of a signed cost, after widening it, maps it to
+	// an unsigned value in the same order.
+	constexpr U signBit = std::is_signed<T>::value ? U(U(1) << (sizeof(U) * 8 - 1)) : 0;
+
+	values.resize(width * height);
+	for (size_t row = 0; row < height; ++row) {
+		const char * cost = costs + ptrdiff_t(row) * rowStride;
+		for (size_t column = 0; column < width; ++column, cost += columnStride) {
+			T value;
+			std::memcpy(&value, cost, sizeof(T));
+			values[row*width+column] = U(value) ^ signBit;
+		}
+	}
+
+	// This constructor solves `values` in place, so it is reused.
+	const APSO apso(values, width, height);
+
+	std::fill(columns, columns + height, -1);
+	for (const auto & result : apso.results)
+		columns[result.y] = int32_t(result.x);
+}
+
+}
+
+
+apso_workspace * apso_workspace_create(void) {
+	return new (std::nothrow) apso_workspace;
+}
+
+void apso_workspace_destroy(apso_workspace * const workspace) {
+	delete workspace;
+}
+
+// The size of each type, by its value.
+static const size_t typeSizes[] = {0, 1, 2, 4, 8, 1, 2, 4, 8};
+
+apso_status apso_solve(const void * const costs, const size_t width, const size_t height, const size_t stride,
+                       const apso_dtype type, int32_t * const columns, apso_workspace * const workspace) {
+	if (type < APSO_U8 || type > APSO_I64 || stride < width) return APSO_INVALID;
+
+	const size_t size = typeSizes[type];
+	return apso_solve_strided(costs, width, height, ptrdiff_t(stride * size), ptrdiff_t(size), type, columns, workspace);
+}
+
+apso_status apso_solve_strided(const void * const costs, const size_t width, const size_t height,
+                               const ptrdiff_t rowStride, const ptrdiff_t columnStride,
+                               const apso_dtype type, int32_t * const columns, apso_workspace * workspace) {
+	if (type < APSO_U8 || type > APSO_I64) return APSO_INVALID;
+
+	// An empty matrix has no costs to read, and no columns to write if it
+	// has no rows.
+	if (!width || !height) {
+		if (height && !columns) return APSO_INVALID;
+		std::fill(columns, columns + height, -1);
+		return APSO_OK;
+	}
+
+	if (!costs || !columns) return APSO_INVALID;
+	if (width > size_t(std::numeric_limits<int32_t>::max())) return APSO_TOO_LARGE;
+
+	thread_local apso_workspace threadWorkspace;
+	if (!workspace) workspace = &threadWorkspace;
+
+	try {
+		switch (type) {
+			case APSO_U8: solve<uint8_t>(static_cast<const char *>(costs), width, height, rowStride, columnStride, columns, *workspace); break;
+			case APSO_U16: solve<uint16_t>(static_cast<const char *>(costs), width, height, rowStride, columnStride, columns, *workspace); break;
+			case APSO_U32: solve<uint32_t>(static_cast<const char *>(costs), width, height, rowStride, columnStride, columns, *workspace); break;
+			case APSO_U64: solve<uint64_t>(static_cast<const char *>(costs), width, height, rowStride, columnStride, columns, *workspace); break;
+			case APSO_I8: solve<int8_t>(static_cast<const char *>(costs), width, height, rowStride, columnStride, columns, *workspace); break;
+			case APSO_I16: solve<int16_t>(static_cast<const char *>(costs), width, height, rowStride, columnStride, columns, *workspace); break;
+			case APSO_I32: solve<int32_t>(static_cast<const char *>(costs), width, height, rowStride, columnStride, columns, *workspace); break;
+			case APSO_I64: solve<int64_t>(static_cast<const char *>(costs), width, height, rowStride, columnStride, columns, *workspace); break;
+		}
+	} catch (const std::bad_alloc &) {
+		return APSO_NO_MEMORY;
+	}
+
+	return APSO_OK;
+}
+
+apso_status apso_solve_batch(apso_problem * const problems, const size_t count, const apso_dtype type,
+                             const unsigned threads, double * const utilization) {
+	if (!problems && count) return APSO_INVALID;
+
+	// The largest are submitted first, so that the small ones fill in the
+	// gaps around them instead of the other way around.
+	std::vector<size_t> order(count);
+	for (size_t i = 0; i < count; ++i) order[i] = i;
+	std::stable_sort(order.begin(), order.end(), [problems](const size_t a, const size_t b) {
+		return problems[a].width * problems[a].height > problems[b].width * problems[b].height;
+	});
+
+	try {
+		APSScheduler scheduler(threads ? threads : std::max(std::thread::hardware_concurrency(), 1u));
+		for (const size_t i : order) {
+			apso_problem & problem = problems[i];
+			scheduler.submit([&problem, type] {
+				problem.status = apso_solve(problem.costs, problem.width, problem.height, problem.stride, type, problem.columns, NULL);
+			});
+		}
+		scheduler.wait();
+
+		if (utilization) {
+			const std::vector<double> busy = scheduler.utilization();
+			std::copy(busy.begin(), busy.end(), utilization);
+		}
+	} catch (const std::bad_alloc &) {
+		return APSO_NO_MEMORY;
+	} catch (const std::system_error &) {
+		return APSO_NO_MEMORY; // a thread could not be started
+	}
+
+	for (size_t i = 0; i < count; ++i)
+		if (problems[i].status != APSO_OK) return problems[i].status;
+	return APSO_OK;
+}
@@ -0,0 +1,135 @@
+/*
+C interface to the Assignment Problem Solver Object in APS.h.
+
+Build it with `make libapso.so`, include this header, and link with -lapso.
+Nothing is allocated by the caller for the library or by the library for the
+caller: the costs are read where they are, and the assignment is written to an
+array the caller owns.
+
+	apso_workspace *workspace = apso_workspace_create();
+	int32_t columns[HEIGHT];
+	if (apso_solve(costs, WIDTH, HEIGHT, WIDTH, APSO_I32, columns, workspace) != APSO_OK)
+		...
+	apso_workspace_destroy(workspace);
+
+A workspace holds the buffers the solver needs between calls, so that solving
+many matrices of about the same size does not allocate them every time. It can
+be NULL, in which case a workspace private to the calling thread is used. A
+workspace must not be used by two threads at the same time.
+
+apso_solve_batch solves many matrices, of any sizes, on a pool of threads that
+take work from each other (see Yay295/APSScheduler.h), and large matrices are
+split up between the threads too. Link with -pthread.
+*/
+
+#ifndef APSO_C_H
+#define APSO_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#if defined(__GNUC__)
+#define APSO_API __attribute__((visibility("default")))
+#else
+#define APSO_API
+#endif
+
+
+/* The type of the costs. These have the same values as Batch/batchfile.h. */
+typedef enum {
+	APSO_U8 = 1,
+	APSO_U16,
+	APSO_U32,
+	APSO_U64,
+	APSO_I8,
+	APSO_I16,
+	APSO_I32,
+	APSO_I64
+} apso_dtype;
+
+/* What apso_solve returns. */
+typedef enum {
+	APSO_OK = 0,
+	APSO_INVALID = 1,  /* a pointer is NULL, the type is unknown, or the stride is too small */
+	APSO_NO_MEMORY = 2,
+	APSO_TOO_LARGE = 3 /* the width does not fit in an int32_t */
+} apso_status;
+
+typedef struct apso_workspace apso_workspace;
+
+/* One matrix of a batch. The fields are the arguments of apso_solve, and
+   status is set to what apso_solve would have returned. */
+typedef struct {
+	const void *costs;
+	size_t width;
+	size_t height;
+	size_t stride;
+	int32_t *columns;
+	apso_status status;
+} apso_problem;
+
+
+/* Returns a new workspace, or NULL if there is not enough memory. */
+APSO_API apso_workspace * apso_workspace_create(void);
+
+/* Frees a workspace. It can be NULL. */
+APSO_API void apso_workspace_destroy(apso_workspace *workspace);
+
+/*
+Finds the assignment with the least total cost.
+
+costs      The first cost of the matrix, of the given type.
+width      The number of columns.
+height     The number of rows.
+stride     The number of costs from the start of one row to the start of the
+           next. It is at least the width. It is larger for a matrix that is
+           part of a larger one.
+type       The type of the costs.
+columns    An array of `height` column numbers. The column assigned to each
+           row is written to it, or -1 for rows that are not assigned (when
+           the matrix is taller than it is wide).
+workspace  A workspace, or NULL.
+
+An empty matrix has nothing to assign, and returns APSO_OK. Its costs may be
+NULL, and so may columns if height is 0.
+*/
+APSO_API apso_status apso_solve(const void *costs, size_t width, size_t height, size_t stride,
+                                apso_dtype type, int32_t *columns, apso_workspace *workspace);
+
+/*
+Like apso_solve, but with the strides in bytes, between rows and between
+columns, like the buffer protocol in Python and NumPy use. They can be negative,
+and do not have to be multiples of the size of the costs.
+*/
+APSO_API apso_status apso_solve_strided(const void *costs, size_t width, size_t height,
+                                        ptrdiff_t row_stride, ptrdiff_t column_stride,
+                                        apso_dtype type, int32_t *columns, apso_workspace *workspace);
+
+/*
+Solves every problem of a batch, all with costs of the given type.
+
+problems     The problems. Each one's status is set.
+count        The number of problems.
+type         The type of the costs.
+threads      The number of threads to use, or 0 for one per CPU.
+utilization  NULL, or an array of `threads` values (or of one per CPU if it is
+             0), which is set to the fraction of the time each thread was
+             busy.
+
+The largest matrices are started first. Returns APSO_OK if every problem was
+solved, and otherwise the status of the first one that was not.
+*/
+APSO_API apso_status apso_solve_batch(apso_problem *problems, size_t count, apso_dtype type,
+                                      unsigned threads, double *utilization);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APSO_C_H */
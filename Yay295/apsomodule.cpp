@@ -0,0 +1,217 @@
+// A Python module for the APSO, built on the C interface in apso.h. Build it
+// with `make python`.
+//
+//	import apso
+//	columns = apso.solve(costs)
+//
+// `costs` can be anything with the buffer protocol, such as a NumPy array or a
+// memoryview, with two dimensions (height, width) or three (count, height,
+// width), and any strides. Its costs are read where they are. Integer costs of
+// any size work directly. Float costs must be whole numbers of at most 2^53,
+// and are copied to integers first, since the APSO only solves integers.
+//
+// It returns a list of the column assigned to each row, or -1 for unassigned
+// rows, or a list of those lists for three dimensions. If `out` is given, the
+// columns are written to it instead, and it is returned. It must be a
+// contiguous, writable buffer of count * height 32 bit integers.
+//
+// The GIL is released while solving, so other Python threads can run, and
+// several threads can solve at once.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include "apso.h"
+
+
+namespace {
+
+// Returns the apso_dtype of a buffer format, or 0 if it is not an integer
+// type. `isFloat` is set if it is a float type.
+int typeOf(const char * format, const Py_ssize_t itemsize, bool & isFloat) {
+	isFloat = false;
+	if (!format) format = "B";
+
+	// Only the native byte order is supported.
+	const bool little = PY_LITTLE_ENDIAN;
+	if (*format == '@' || *format == '=' || (*format == '<' && little) || ((*format == '>' || *format == '!') && !little)) ++format;
+	if (format[0] == '\0' || format[1] != '\0') return 0;
+
+	bool isSigned;
+	switch (*format) {
+		case 'b': case 'h': case 'i': case 'l': case 'q': case 'n': isSigned = true; break;
+		case 'B': case 'H': case 'I': case 'L': case 'Q': case 'N': case '?': isSigned = false; break;
+		case 'f': case 'd': isFloat = itemsize == sizeof(float) || itemsize == sizeof(double); return 0;
+		default: return 0;
+	}
+
+	switch (itemsize) {
+		case 1: return isSigned ? APSO_I8 : APSO_U8;
+		case 2: return isSigned ? APSO_I16 : APSO_U16;
+		case 4: return isSigned ? APSO_I32 : APSO_U32;
+		case 8: return isSigned ? APSO_I64 : APSO_U64;
+		default: return 0;
+	}
+}
+
+// Copies a matrix of float costs to integers. Returns false if one is not a
+// whole number that a double can hold exactly.
+template<typename F>
+bool wholeNumbers(const char * costs, const size_t width, const size_t height, const Py_ssize_t rowStride,
+                  const Py_ssize_t columnStride, std::vector<int64_t> & values) {
+	values.resize(width * height);
+	for (size_t row = 0; row < height; ++row) {
+		const char * cost = costs + Py_ssize_t(row) * rowStride;
+		for (size_t column = 0; column < width; ++column, cost += columnStride) {
+			F value;
+			std::memcpy(&value, cost, sizeof(F));
+			if (!(std::fabs(value) <= 9007199254740992.0) || value != std::trunc(value)) return false;
+			values[row*width+column] = int64_t(value);
+		}
+	}
+	return true;
+}
+
+// Raises the Python exception for a status, and returns NULL.
+PyObject * raise(const apso_status status) {
+	if (status == APSO_NO_MEMORY) return PyErr_NoMemory();
+	if (status == APSO_TOO_LARGE) PyErr_SetString(PyExc_ValueError, "the matrix is too wide");
+	else PyErr_SetString(PyExc_ValueError, "the matrix could not be solved");
+	return nullptr;
+}
+
+
+PyObject * solve(PyObject *, PyObject * args, PyObject * keywords) {
+	static const char * keywordNames[] = {"costs", "out", nullptr};
+	PyObject * costsObject, * outObject = nullptr;
+	if (!PyArg_ParseTupleAndKeywords(args, keywords, "O|O:solve", const_cast<char **>(keywordNames), &costsObject, &outObject))
+		return nullptr;
+
+	Py_buffer costs;
+	if (PyObject_GetBuffer(costsObject, &costs, PyBUF_RECORDS_RO) != 0) return nullptr;
+
+	// Releases the buffers however this returns.
+	struct Release {
+		Py_buffer * buffer;
+		~Release() { if (buffer) PyBuffer_Release(buffer); }
+	} releaseCosts = {&costs}, releaseOut = {nullptr};
+
+	if (costs.ndim != 2 && costs.ndim != 3) {
+		PyErr_SetString(PyExc_ValueError, "costs must have two or three dimensions");
+		return nullptr;
+	}
+
+	bool isFloat;
+	const int type = typeOf(costs.format, costs.itemsize, isFloat);
+	if (!type && !isFloat) {
+		PyErr_Format(PyExc_TypeError, "costs of format '%s' are not supported", costs.format ? costs.format : "B");
+		return nullptr;
+	}
+
+	const bool batched = costs.ndim == 3;
+	const size_t count = batched ? size_t(costs.shape[0]) : 1;
+	const size_t height = size_t(costs.shape[costs.ndim-2]), width = size_t(costs.shape[costs.ndim-1]);
+	const Py_ssize_t matrixStride = batched ? costs.strides[0] : 0;
+	const Py_ssize_t rowStride = costs.strides[costs.ndim-2], columnStride = costs.strides[costs.ndim-1];
+
+	Py_buffer out;
+	std::vector<int32_t> columns;
+	int32_t * results;
+	if (outObject) {
+		if (PyObject_GetBuffer(outObject, &out, PyBUF_WRITABLE | PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) != 0) return nullptr;
+		releaseOut.buffer = &out;
+
+		bool outIsFloat;
+		const int outType = typeOf(out.format, out.itemsize, outIsFloat);
+		if ((outType != APSO_I32 && outType != APSO_U32) || size_t(out.len) != count * height * sizeof(int32_t)) {
+			PyErr_SetString(PyExc_ValueError, "out must be count * height 32 bit integers");
+			return nullptr;
+		}
+		results = static_cast<int32_t *>(out.buf);
+	} else {
+		columns.resize(count * height);
+		results = columns.data();
+	}
+
+	// An empty matrix has nothing to solve, and none of its rows, if it has
+	// any, are assigned.
+	const size_t solved = width && height ? count : 0;
+	std::fill(results + solved * height, results + count * height, -1);
+
+	apso_status status = APSO_OK;
+	bool whole = true;
+	std::vector<int64_t> values;
+
+	Py_BEGIN_ALLOW_THREADS
+	for (size_t i = 0; i < solved && status == APSO_OK; ++i) {
+		const char * const matrix = static_cast<const char *>(costs.buf) + Py_ssize_t(i) * matrixStride;
+		int32_t * const matrixColumns = results + i * height;
+
+		if (!isFloat) {
+			status = apso_solve_strided(matrix, width, height, rowStride, columnStride, apso_dtype(type), matrixColumns, nullptr);
+			continue;
+		}
+
+		whole = costs.itemsize == sizeof(float)
+			? wholeNumbers<float>(matrix, width, height, rowStride, columnStride, values)
+			: wholeNumbers<double>(matrix, width, height, rowStride, columnStride, values);
+		status = whole
+			? apso_solve(values.data(), width, height, width, APSO_I64, matrixColumns, nullptr)
+			: APSO_INVALID;
+	}
+	Py_END_ALLOW_THREADS
+
+	if (!whole) {
+		PyErr_SetString(PyExc_ValueError, "float costs must be whole numbers of at most 2**53");
+		return nullptr;
+	}
+	if (status != APSO_OK) return raise(status);
+
+	if (outObject) {
+		Py_INCREF(outObject);
+		return outObject;
+	}
+
+	// Build the lists.
+	PyObject * const list = PyList_New(Py_ssize_t(batched ? count : height));
+	if (!list) return nullptr;
+	for (size_t i = 0; i < count; ++i) {
+		PyObject * const rows = batched ? PyList_New(Py_ssize_t(height)) : list;
+		if (!rows) {
+			Py_DECREF(list);
+			return nullptr;
+		}
+		for (size_t row = 0; row < height; ++row)
+			PyList_SET_ITEM(rows, Py_ssize_t(row), PyLong_FromLong(results[i*height+row]));
+		if (batched) PyList_SET_ITEM(list, Py_ssize_t(i), rows);
+	}
+	return list;
+}
+
+
+PyMethodDef methods[] = {
+	{"solve", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(solve)), METH_VARARGS | METH_KEYWORDS,
+	 "solve(costs, out=None)\n\n"
+	 "Finds the assignment with the least total cost. costs is a buffer of\n"
+	 "two dimensions (height, width) or three (count, height, width). Returns\n"
+	 "the column assigned to each row, or -1, as a list, or a list of lists\n"
+	 "for three dimensions. If out is given, they are written to it instead."},
+	{nullptr, nullptr, 0, nullptr}
+};
+
+PyModuleDef module = {
+	PyModuleDef_HEAD_INIT, "apso", "Yay295's Assignment Problem Solver.", -1, methods,
+	nullptr, nullptr, nullptr, nullptr
+};
+
+}
+
+
+PyMODINIT_FUNC PyInit_apso(void) {
+	return PyModule_Create(&module);
+}